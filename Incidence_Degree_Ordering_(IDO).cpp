@@ -1,518 +1,1095 @@
+#include "graph_coloring.h"
+
 #include <iostream>
 #include <vector>
 #include <string>
 #include <fstream>
 #include <sstream>
-#include <algorithm> // For std::sort, std::max, std::remove
+#include <algorithm> // For std::max
 #include <chrono>    // For high-resolution timing
-#include <set>       // For calculating saturation degree (unique colors for DSATUR)
-#include <numeric>   // For std::iota if needed (not directly used in final structure)
-
-// Structure to represent a vertex
-struct Vertex {
-    int id;
-    int degree;
-    int color; // -1 indicates uncolored
-    std::vector<int> neighbors;
-    // This field is repurposed based on the algorithm:
-    // For IDO: stores count of ALL colored neighbors
-    // For DSATUR: stores saturation degree (count of UNIQUE colors of neighbors)
-    // For RLF: stores count of neighbors in the 'U' set (forbidden for current color)
-    int heuristic_value; 
-
-    // Default constructor for vector resizing and initialization
-    Vertex(int i = 0) : id(i), degree(0), color(-1), heuristic_value(0) {}
-};
+#include <cstdlib>   // For std::atoi, std::malloc
+#include <cstring>   // For std::memset, std::strerror
+#include <cerrno>    // For errno when opening hardware counters
+#include <atomic>    // For the allocation counters
+#include <new>       // For replacing the global operator new/delete
+#include <cstddef>   // For std::max_align_t
+#include <iomanip>   // For std::setprecision in memory reports
+#include <map>       // For the color count distribution of multi-start runs
+#include <numeric>   // For std::iota (identity vertex IDs)
+#include <random>    // For the random updates of the dynamic coloring benchmark
+#include <thread>    // For std::thread::hardware_concurrency and the server workers
+#include <mutex>     // For the server's connection queue, graph cache and latencies
+#include <condition_variable>
+#include <deque>
+#include <cmath>     // For std::ceil, std::isfinite
+#include <cctype>    // For std::isspace
+#include <cstdio>    // For std::snprintf
+
+#ifdef __linux__
+#include <malloc.h>  // For malloc_usable_size
+#include <linux/perf_event.h> // Hardware performance counters
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <sys/socket.h> // Unix domain socket of --serve
+#include <sys/stat.h>
+#include <sys/un.h>
+#endif
+
+// Hardware performance counters (Linux perf_event_open) collected around one algorithm run.
+// Each event is opened on its own so that a container or VM that only exposes some of
+// them still reports the rest; unavailable events are reported as "n/a".
+class PerfCounters {
+public:
+    enum Event { Cycles, Instructions, LLCMisses, BranchMisses, NumEvents };
+
+    // Values of the last start()/stop() interval, -1 for events that could not be opened
+    struct Reading {
+        long long values[NumEvents] = {-1, -1, -1, -1};
+    };
 
-// Function to parse the DIMACS graph file format (including .col extension)
-bool readGraphFile(const std::string& filename, std::vector<Vertex>& vertices, int& num_vertices, int& num_edges) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open file '" << filename << "'" << std::endl;
-        return false;
+    PerfCounters() {
+        for (int e = 0; e < NumEvents; ++e) {
+            fds_[e] = -1;
+        }
+#ifdef __linux__
+        const unsigned long long configs[NumEvents] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES, // Last level cache misses
+            PERF_COUNT_HW_BRANCH_MISSES,
+        };
+        for (int e = 0; e < NumEvents; ++e) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[e];
+            attr.disabled = 1;
+            attr.exclude_kernel = 1; // Allowed with perf_event_paranoid <= 2
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds_[e] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+            if (fds_[e] < 0 && unavailable_reason_.empty()) {
+                unavailable_reason_ = std::strerror(errno);
+            }
+        }
+#else
+        unavailable_reason_ = "perf_event_open is only available on Linux";
+#endif
     }
 
-    std::string line;
-    bool problem_line_found = false;
-    vertices.clear(); // Clear any previous graph data before reading a new one
-
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        char type;
-        if (!(iss >> type)) { // Try to read the first character, skip empty lines
-            continue;
-        }
-
-        if (type == 'c') {
-            // Comment line, ignore
-            continue;
-        } else if (type == 'p') {
-            std::string problem_type;
-            if (!(iss >> problem_type >> num_vertices >> num_edges)) {
-                std::cerr << "Error: Malformed 'p' line in '" << filename << "'" << std::endl;
-                return false;
+    ~PerfCounters() {
+#ifdef __linux__
+        for (int e = 0; e < NumEvents; ++e) {
+            if (fds_[e] >= 0) {
+                close(fds_[e]);
             }
-            // Allow "edge" and "col" problem types for graph coloring benchmarks
-            if (problem_type != "edge" && problem_type != "col") {
-                std::cerr << "Error: Unsupported problem type '" << problem_type << "' in '" << filename << "'. Only 'edge' or 'col' types are supported by this parser." << std::endl;
-                return false;
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // True if at least one event could be opened
+    bool available() const {
+        for (int e = 0; e < NumEvents; ++e) {
+            if (fds_[e] >= 0) {
+                return true;
             }
-            // Resize and initialize vertices. Using 1-indexing for convenience to match file format.
-            vertices.resize(num_vertices + 1);
-            for (int i = 1; i <= num_vertices; ++i) {
-                vertices[i].id = i;
-                vertices[i].color = -1; // Ensure it's uncolored
-                vertices[i].degree = 0; // Ensure degree is reset
-                vertices[i].neighbors.clear(); // Ensure neighbors list is clear
-                vertices[i].heuristic_value = 0; // Ensure heuristic value is reset
-            }
-            problem_line_found = true;
-        } else if (type == 'e') {
-            if (!problem_line_found) {
-                std::cerr << "Error: 'e' line found before 'p' line in '" << filename << "'" << std::endl;
-                return false;
+        }
+        return false;
+    }
+
+    // Reason reported by the kernel for the first event that could not be opened
+    const std::string& unavailableReason() const { return unavailable_reason_; }
+
+    void start() {
+#ifdef __linux__
+        for (int e = 0; e < NumEvents; ++e) {
+            if (fds_[e] >= 0) {
+                ioctl(fds_[e], PERF_EVENT_IOC_RESET, 0);
+                ioctl(fds_[e], PERF_EVENT_IOC_ENABLE, 0);
             }
-            int u, v;
-            if (!(iss >> u >> v)) {
-                std::cerr << "Error: Malformed 'e' line in '" << filename << "'" << std::endl;
-                return false;
+        }
+#endif
+    }
+
+    Reading stop() {
+        Reading reading;
+#ifdef __linux__
+        for (int e = 0; e < NumEvents; ++e) {
+            if (fds_[e] >= 0) {
+                ioctl(fds_[e], PERF_EVENT_IOC_DISABLE, 0);
             }
-            // Add edges. Since it's an undirected graph, add to both adjacency lists.
-            if (u > 0 && u <= num_vertices && v > 0 && v <= num_vertices) {
-                vertices[u].neighbors.push_back(v);
-                vertices[v].neighbors.push_back(u);
-                vertices[u].degree++;
-                vertices[v].degree++;
-            } else {
-                std::cerr << "Warning: Invalid vertex ID (" << u << ", " << v << ") in edge in '" << filename << "'. Max vertex ID is " << num_vertices << std::endl;
+        }
+        for (int e = 0; e < NumEvents; ++e) {
+            unsigned long long data[3]; // value, time enabled, time running
+            if (fds_[e] < 0 || read(fds_[e], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) {
+                continue;
             }
+            // Scale up if the kernel had to multiplex the event with others
+            double scale = (data[2] > 0 && data[2] < data[1]) ? static_cast<double>(data[1]) / data[2] : 1.0;
+            reading.values[e] = data[2] > 0 ? static_cast<long long>(data[0] * scale) : 0;
         }
+#endif
+        return reading;
     }
-    file.close();
 
-    if (!problem_line_found) {
-        std::cerr << "Error: No 'p' line found in '" << filename << "'" << std::endl;
-        return false;
+private:
+    int fds_[NumEvents];
+    std::string unavailable_reason_;
+};
+
+// Formats a counter reading as the indented lines printed below "CPU Time"
+std::string formatPerfReading(const PerfCounters::Reading& reading) {
+    auto value = [&reading](PerfCounters::Event e) {
+        return reading.values[e] < 0 ? std::string("n/a") : std::to_string(reading.values[e]);
+    };
+    std::ostringstream out;
+    out << "    Cycles:        " << value(PerfCounters::Cycles) << "\n";
+    out << "    Instructions:  " << value(PerfCounters::Instructions);
+    if (reading.values[PerfCounters::Cycles] > 0 && reading.values[PerfCounters::Instructions] >= 0) {
+        out << " (IPC " << static_cast<double>(reading.values[PerfCounters::Instructions]) / reading.values[PerfCounters::Cycles] << ")";
     }
-    return true;
+    out << "\n";
+    out << "    LLC Misses:    " << value(PerfCounters::LLCMisses) << "\n";
+    out << "    Branch Misses: " << value(PerfCounters::BranchMisses);
+    return out.str();
 }
 
-// Function to check if a color is valid for a vertex
-bool isColorValid(const Vertex& current_vertex, int color, const std::vector<Vertex>& all_vertices) {
-    for (int neighbor_id : current_vertex.neighbors) {
-        // Check if the neighbor is colored and has the same color
-        if (all_vertices[neighbor_id].color == color) {
-            return false;
+// Heap accounting through replaced global operator new/delete. Every allocation made by
+// the program (vectors, sets, strings...) updates these counters, which main() reads
+// around graph loading and around each algorithm run. Sizes are the usable sizes
+// reported by the allocator, so the numbers match what the process actually holds.
+// malloc_usable_size is glibc-specific, so elsewhere the operators are left alone and
+// the heap figures are reported as "n/a".
+struct HeapCounters {
+    long long current_bytes = 0;   // Bytes live right now
+    long long peak_bytes = 0;      // Highest current_bytes since the last resetPeak()
+    long long allocations = 0;     // Number of allocations so far
+    long long allocated_bytes = 0; // Total bytes ever allocated
+};
+
+class MemoryAccounting {
+public:
+#ifdef __linux__
+    static const bool kEnabled = true;
+#else
+    static const bool kEnabled = false;
+#endif
+
+#ifdef __linux__
+    static void recordAllocation(void* ptr) {
+        long long bytes = static_cast<long long>(malloc_usable_size(ptr));
+        long long now = current_bytes_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        allocated_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+        long long peak = peak_bytes_.load(std::memory_order_relaxed);
+        while (now > peak && !peak_bytes_.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {
         }
     }
-    return true;
-}
 
-// Helper function to find the uncolored vertex with the largest degree
-// Returns a pointer to the vertex, or nullptr if no uncolored vertices remain.
-Vertex* find_max_degree_uncolored_vertex(std::vector<Vertex>& vertices, int num_vertices) {
-    Vertex* max_degree_vertex = nullptr;
-    int max_degree = -1;
+    static void recordDeallocation(void* ptr) {
+        current_bytes_.fetch_sub(static_cast<long long>(malloc_usable_size(ptr)), std::memory_order_relaxed);
+    }
+#endif
+
+    static HeapCounters snapshot() {
+        HeapCounters counters;
+        counters.current_bytes = current_bytes_.load(std::memory_order_relaxed);
+        counters.peak_bytes = peak_bytes_.load(std::memory_order_relaxed);
+        counters.allocations = allocations_.load(std::memory_order_relaxed);
+        counters.allocated_bytes = allocated_bytes_.load(std::memory_order_relaxed);
+        return counters;
+    }
 
-    for (int i = 1; i <= num_vertices; ++i) {
-        if (vertices[i].color == -1) { // If uncolored
-            if (max_degree_vertex == nullptr || vertices[i].degree > max_degree) {
-                max_degree = vertices[i].degree;
-                max_degree_vertex = &vertices[i];
-            }
-        }
+    // Starts a new peak measurement from the bytes currently live
+    static void resetPeak() {
+        peak_bytes_.store(current_bytes_.load(std::memory_order_relaxed), std::memory_order_relaxed);
     }
-    return max_degree_vertex;
+
+private:
+    static std::atomic<long long> current_bytes_;
+    static std::atomic<long long> peak_bytes_;
+    static std::atomic<long long> allocations_;
+    static std::atomic<long long> allocated_bytes_;
+};
+
+std::atomic<long long> MemoryAccounting::current_bytes_{0};
+std::atomic<long long> MemoryAccounting::peak_bytes_{0};
+std::atomic<long long> MemoryAccounting::allocations_{0};
+std::atomic<long long> MemoryAccounting::allocated_bytes_{0};
+
+#ifdef __linux__
+void* trackedAllocate(std::size_t size, std::size_t alignment = 0) {
+    void* ptr = alignment > alignof(std::max_align_t)
+                    ? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)
+                    : std::malloc(size ? size : 1);
+    if (ptr != nullptr) {
+        MemoryAccounting::recordAllocation(ptr);
+    }
+    return ptr;
 }
 
-// Common logic for greedy coloring algorithms (IDO and DSATUR)
-// Heuristic calculation and selection varies by algorithm
-// Returns the total number of colors used
-int generic_greedy_coloring(std::vector<Vertex>& vertices, int num_vertices, const std::string& alg_name) {
-    std::vector<int> color_palette; // Stores the distinct colors used (e.g., 0, 1, 2)
-    int next_available_color_idx = 0; // The next color to try if no existing color fits
-
-    // Create a list of pointers to uncolored vertices for efficient sorting and removal.
-    std::vector<Vertex*> uncolored_vertices_ptrs;
-    uncolored_vertices_ptrs.reserve(num_vertices); // Pre-allocate memory
-
-    // Initialize all vertices to uncolored and populate the pointers vector
-    for (int i = 1; i <= num_vertices; ++i) {
-        vertices[i].color = -1; // Ensure a clean state for coloring for this run
-        uncolored_vertices_ptrs.push_back(&vertices[i]);
-    }
-
-    // Handle empty graph case
-    if (uncolored_vertices_ptrs.empty()) {
-        return 0; // No vertices, no colors needed
-    }
-
-    // Step 2 (for IDO/DSATUR): Select the uncolored vertex that has the largest degree.
-    // This initial sort applies to both algorithms for the very first vertex.
-    std::sort(uncolored_vertices_ptrs.begin(), uncolored_vertices_ptrs.end(),
-              [](const Vertex* a, const Vertex* b) {
-                  return a->degree > b->degree;
-              });
-
-    // Color the first selected vertex (highest degree) with the first color (0)
-    Vertex* initial_vertex = uncolored_vertices_ptrs[0];
-    initial_vertex->color = next_available_color_idx;
-    color_palette.push_back(next_available_color_idx);
-    next_available_color_idx++;
-
-    // Remove the colored vertex from the uncolored list of pointers
-    uncolored_vertices_ptrs.erase(
-        std::remove(uncolored_vertices_ptrs.begin(), uncolored_vertices_ptrs.end(), initial_vertex),
-        uncolored_vertices_ptrs.end());
-
-
-    // Main coloring loop (Step 5: If uncolored vertex exists, return to step 3)
-    while (!uncolored_vertices_ptrs.empty()) {
-        // Step 3: Calculate the heuristic value and find the best vertex for this iteration.
-        Vertex* best_vertex_for_this_iteration = nullptr;
-
-        for (Vertex* v_ptr : uncolored_vertices_ptrs) {
-            if (alg_name == "DSATUR") {
-                std::set<int> distinct_neighbor_colors;
-                for (int neighbor_id : v_ptr->neighbors) {
-                    if (vertices[neighbor_id].color != -1) { // If neighbor is colored
-                        distinct_neighbor_colors.insert(vertices[neighbor_id].color);
-                    }
-                }
-                v_ptr->heuristic_value = distinct_neighbor_colors.size();
-            } else { // Assume IDO if not DSATUR
-                v_ptr->heuristic_value = 0; // Reset count for current iteration
-                for (int neighbor_id : v_ptr->neighbors) {
-                    if (vertices[neighbor_id].color != -1) { // If neighbor is colored
-                        v_ptr->heuristic_value++;
-                    }
-                }
-            }
+// Kept out of line: once inlined into operator delete, GCC sees std::free() applied to
+// memory from operator new and reports a false -Wmismatched-new-delete.
+__attribute__((noinline)) void trackedFree(void* ptr) noexcept {
+    if (ptr != nullptr) {
+        MemoryAccounting::recordDeallocation(ptr);
+        std::free(ptr);
+    }
+}
 
-            // Select the uncolored vertex with the maximum heuristic_value.
-            // If tied, select the one with the largest degree among them.
-            if (best_vertex_for_this_iteration == nullptr ||
-                v_ptr->heuristic_value > best_vertex_for_this_iteration->heuristic_value ||
-                (v_ptr->heuristic_value == best_vertex_for_this_iteration->heuristic_value && v_ptr->degree > best_vertex_for_this_iteration->degree)) {
-                
-                best_vertex_for_this_iteration = v_ptr;
-            }
-        }
+void* operator new(std::size_t size) {
+    void* ptr = trackedAllocate(size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    void* ptr = trackedAllocate(size, static_cast<std::size_t>(alignment));
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) { return operator new(size, alignment); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return trackedAllocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return trackedAllocate(size); }
+void operator delete(void* ptr) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { trackedFree(ptr); }
+#endif
+
+// Resident set size of the process from /proc/self/status (Linux), in bytes; -1 if unavailable.
+// VmHWM is the peak RSS, which resetPeakResidentSetSize() restarts from the current RSS.
+struct ResidentSetSize {
+    long long current_bytes = -1;
+    long long peak_bytes = -1;
+};
 
-        if (best_vertex_for_this_iteration == nullptr) {
-            std::cerr << "Warning [" << alg_name << "]: No best vertex found while uncolored_vertices_ptrs is not empty. Breaking loop." << std::endl;
-            break;
+ResidentSetSize sampleResidentSetSize() {
+    ResidentSetSize rss;
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        long long kilobytes = 0;
+        if (line.compare(0, 6, "VmRSS:") == 0 && std::istringstream(line.substr(6)) >> kilobytes) {
+            rss.current_bytes = kilobytes * 1024;
+        } else if (line.compare(0, 6, "VmHWM:") == 0 && std::istringstream(line.substr(6)) >> kilobytes) {
+            rss.peak_bytes = kilobytes * 1024;
         }
+    }
+    return rss;
+}
 
-        // Step 4: Try to color the selected vertex with existing colors.
-        int chosen_color = -1;
-        for (int c : color_palette) {
-            if (isColorValid(*best_vertex_for_this_iteration, c, vertices)) {
-                chosen_color = c;
-                break; // Found a valid existing color
-            }
-        }
+void resetPeakResidentSetSize() {
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5"; // Resets VmHWM to the current RSS; silently ignored if not permitted
+}
+
+// Memory used by one measured step (graph loading or an algorithm run)
+struct MemoryReport {
+    long long peak_heap_bytes = 0;   // Highest live heap of the process during the step
+    long long step_peak_bytes = 0;   // The same peak, above what was live before the step
+    long long allocations = 0;       // Allocations made during the step (-1: heap not tracked)
+    long long allocated_bytes = 0;   // Bytes allocated during the step
+    long long live_bytes = 0;        // Live heap after the step
+    ResidentSetSize rss;             // RSS after the step and peak RSS during it
+};
+
+// Brackets a step: construct before it, call finish() after it
+class MemoryMeasurement {
+public:
+    MemoryMeasurement() {
+        resetPeakResidentSetSize();
+        MemoryAccounting::resetPeak();
+        start_ = MemoryAccounting::snapshot();
+    }
 
-        if (chosen_color == -1) {
-            // No existing color is suitable, assign a new color
-            chosen_color = next_available_color_idx;
-            color_palette.push_back(chosen_color);
-            next_available_color_idx++;
+    MemoryReport finish() const {
+        HeapCounters end = MemoryAccounting::snapshot();
+        MemoryReport report;
+        report.peak_heap_bytes = end.peak_bytes;
+        report.step_peak_bytes = end.peak_bytes - start_.current_bytes;
+        report.allocations = end.allocations - start_.allocations;
+        report.allocated_bytes = end.allocated_bytes - start_.allocated_bytes;
+        report.live_bytes = end.current_bytes;
+        if (!MemoryAccounting::kEnabled) {
+            report.peak_heap_bytes = report.step_peak_bytes = -1;
+            report.allocations = report.allocated_bytes = report.live_bytes = -1;
         }
+        report.rss = sampleResidentSetSize();
+        return report;
+    }
 
-        best_vertex_for_this_iteration->color = chosen_color;
+private:
+    HeapCounters start_;
+};
 
-        // Remove the colored vertex from the uncolored list of pointers
-        uncolored_vertices_ptrs.erase(
-            std::remove(uncolored_vertices_ptrs.begin(), uncolored_vertices_ptrs.end(), best_vertex_for_this_iteration),
-            uncolored_vertices_ptrs.end());
+// Byte counts in KB below one megabyte and in MB above it
+std::string formatBytes(long long bytes) {
+    if (bytes < 0) {
+        return "n/a";
+    }
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    if (bytes < 1024 * 1024) {
+        out << bytes / 1024.0 << " KB";
+    } else {
+        out << bytes / (1024.0 * 1024.0) << " MB";
     }
+    return out.str();
+}
 
-    return next_available_color_idx; // Return the total number of colors used
+// One line in the style of the other indented result lines
+std::string formatMemoryReport(const std::string& label, const MemoryReport& report) {
+    std::ostringstream out;
+    out << label << "peak heap " << formatBytes(report.peak_heap_bytes) << " (+" << formatBytes(report.step_peak_bytes) << "), "
+        << (report.allocations < 0 ? std::string("n/a") : std::to_string(report.allocations)) << " allocations, " << formatBytes(report.allocated_bytes) << " allocated, "
+        << "live heap " << formatBytes(report.live_bytes) << ", "
+        << "RSS " << formatBytes(report.rss.current_bytes) << " (peak " << formatBytes(report.rss.peak_bytes) << ")";
+    return out.str();
 }
 
-// Wrapper for IDO
-int IDO_coloring(std::vector<Vertex>& vertices, int num_vertices) {
-    return generic_greedy_coloring(vertices, num_vertices, "IDO");
+// Indented line with the outcome of a graph cache lookup and the cache counters
+std::string formatGraphCacheReport(bool hit, const GraphCacheStats& stats) {
+    std::ostringstream out;
+    out << "  Graph Cache: " << (hit ? "hit" : "miss") << ", " << stats.graphs << (stats.graphs == 1 ? " graph, " : " graphs, ")
+        << formatBytes(static_cast<long long>(stats.bytes)) << " of " << formatBytes(static_cast<long long>(stats.byte_budget))
+        << " held (" << stats.hits << " hits, " << stats.misses << " misses, " << stats.evictions << " evictions)";
+    return out.str();
 }
 
-// Wrapper for DSATUR
-int DSATUR_coloring(std::vector<Vertex>& vertices, int num_vertices) {
-    return generic_greedy_coloring(vertices, num_vertices, "DSATUR");
+// Indented lines with the seed statistics, color count distribution and throughput of a
+// multi-start run
+std::string formatMultiStartReport(const MultiStartResult& result, unsigned long long first_seed) {
+    std::map<int, int> distribution; // Colors used -> number of seeds
+    long long total_colors = 0;
+    for (int colors_used : result.colors_per_seed) {
+        distribution[colors_used]++;
+        total_colors += colors_used;
+    }
+    std::ostringstream out;
+    out << "    Seeds:       " << result.colors_per_seed.size() << " from " << first_seed << " (best seed " << result.best_seed
+        << "), colors min " << distribution.begin()->first << " / mean " << std::fixed << std::setprecision(2)
+        << static_cast<double>(total_colors) / result.colors_per_seed.size() << " / max " << distribution.rbegin()->first << "\n";
+    out << "    Distribution:";
+    for (auto entry = distribution.begin(); entry != distribution.end(); ++entry) {
+        out << (entry == distribution.begin() ? " " : ", ") << entry->first << " colors x" << entry->second;
+    }
+    out << "\n    Throughput:  " << result.colorings_per_second << " colorings/s, " << result.colorings_per_second_per_core
+        << " per core (" << result.num_threads << (result.num_threads == 1 ? " thread)" : " threads)");
+    return out.str();
 }
 
-// Implementation of the Recursive Largest First Algorithm (RLF)
-int RLF_coloring(std::vector<Vertex>& vertices, int num_vertices) {
-    int current_color = 0;
-    int total_colored_vertices = 0;
+// Indented line with the outcome of the Kempe chain post-pass
+std::string formatKempeReport(const KempeReductionResult& result) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    out << "    Kempe:       " << result.initial_colors << " -> " << result.coloring.colors_used << " colors in "
+        << result.elapsed_ms << " ms (" << result.direct_moves << " direct moves, " << result.chain_swaps << " chain swaps)";
+    return out.str();
+}
+
+// Indented lines with the outcome of Iterated Greedy and every pass that saved colors
+std::string formatIteratedGreedyReport(const IteratedGreedyResult& result) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    out << "    Iterated Greedy: " << result.initial_colors << " -> " << result.coloring.colors_used << " colors, "
+        << result.iterations << " passes in " << result.elapsed_ms << " ms (" << result.iterations_per_second << " passes/s)";
+    for (const IteratedGreedyImprovement& improvement : result.improvements) {
+        out << "\n      pass " << improvement.iteration << " at " << improvement.elapsed_ms << " ms ("
+            << classOrderName(improvement.order) << "): " << improvement.colors_used << " colors";
+    }
+    return out.str();
+}
 
-    // Reset all vertex colors at the start of RLF run
-    for (int i = 1; i <= num_vertices; ++i) {
-        vertices[i].color = -1;
+// Indented lines with the course of a hybrid evolutionary run: one line per legal
+// coloring that improved on the best so far
+std::string formatHEAReport(const HEAResult& result, int population_size) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    out << "    HEA:         started from " << result.initial_colors << " colors, " << result.generations
+        << " generations, population " << population_size << ", " << result.num_threads
+        << (result.num_threads == 1 ? " thread" : " threads") << ", TabuCol tables "
+        << formatBytes(static_cast<long long>(result.tabu_table_bytes));
+    for (size_t i = 1; i < result.progress.size(); ++i) {
+        out << "\n      " << result.progress[i].elapsed_ms << " ms (generation " << result.progress[i].generation
+            << "): " << result.progress[i].colors_used << " colors";
     }
+    return out.str();
+}
 
-    // Outer loop: Iterate through colors until all vertices are colored
-    while (total_colored_vertices < num_vertices) {
-        // Step 1: Select the uncolored vertex which has the largest degree.
-        Vertex* v_i = find_max_degree_uncolored_vertex(vertices, num_vertices);
+// Indented line with the outcome of a PartialCol run
+std::string formatPartialColReport(const PartialColResult& result, int num_colors, Algorithm initial_algorithm) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    out << "    PartialCol:  " << (result.success ? "legal " : "no legal ") << num_colors << "-coloring"
+        << (result.success ? " found" : " within the budget, " + std::to_string(result.uncolored) + " vertices left uncolored")
+        << "; started from " << algorithmName(initial_algorithm) << " with " << result.initial_uncolored
+        << " vertices uncolored, " << result.iterations << " moves (" << result.iterations_per_second << " moves/s)";
+    return out.str();
+}
 
-        if (v_i == nullptr) { // Should not happen if total_colored_vertices < num_vertices
-            std::cerr << "Warning [RLF]: No uncolored vertex found unexpectedly. Breaking loop." << std::endl;
-            break;
+// Applies num_updates random updates to a dynamic coloring of graph, starting from its
+// DSATUR coloring: 49% edge insertions, 49% edge removals, 1% insertions of a vertex with
+// average degree and 1% vertex removals. Returns the indented report lines.
+std::string runDynamicBenchmark(const Graph& graph, long long num_updates, unsigned long long seed) {
+    ColoringResult initial = colorGraph(graph, Algorithm::DSATUR);
+    DynamicColoring dynamic(graph, initial.colors);
+    std::mt19937_64 random(seed);
+    int average_degree = graph.numVertices() > 0 ? static_cast<int>(2 * dynamic.numEdges() / graph.numVertices()) : 0;
+    std::vector<int> new_neighbors;
+
+    auto start_time = std::chrono::steady_clock::now();
+    for (long long update = 0; update < num_updates && dynamic.numVertices() > 0; ++update) {
+        auto random_vertex = [&]() {
+            int v;
+            do {
+                v = 1 + static_cast<int>(random() % dynamic.maxVertexId());
+            } while (!dynamic.hasVertex(v));
+            return v;
+        };
+        int kind = static_cast<int>(random() % 100);
+        if (kind < 49) {
+            // Retry on existing edges, so dense graphs keep their density
+            for (int attempt = 0; attempt < 100; ++attempt) {
+                int u = random_vertex();
+                int v = random_vertex();
+                if (u != v && !dynamic.hasEdge(u, v)) {
+                    dynamic.addEdge(u, v);
+                    break;
+                }
+            }
+        } else if (kind < 98) {
+            int u = random_vertex();
+            if (!dynamic.neighbors(u).empty()) {
+                dynamic.removeEdge(u, dynamic.neighbors(u)[random() % dynamic.neighbors(u).size()]);
+            }
+        } else if (kind < 99) {
+            new_neighbors.clear();
+            for (int i = 0; i < average_degree; ++i) {
+                new_neighbors.push_back(random_vertex());
+            }
+            dynamic.addVertex(new_neighbors);
+        } else {
+            dynamic.removeVertex(random_vertex());
         }
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start_time;
+
+    const DynamicColoringStats& stats = dynamic.stats();
+    Graph final_graph = dynamic.graph();
+    ColoringResult final_coloring = dynamic.coloring();
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    out << "    Updates:     " << stats.updates << " in " << elapsed.count() << " ms ("
+        << (elapsed.count() > 0.0 ? stats.updates * 1000.0 / elapsed.count() : 0.0) << " updates/s)\n";
+    out << "    Recolored:   " << (stats.updates > 0 ? static_cast<double>(stats.recolored_vertices) / stats.updates : 0.0)
+        << " vertices per update (max " << stats.max_recolored << "), " << stats.new_colors << " new colors opened, "
+        << stats.neighbor_moves << " avoided by moving a neighbor\n";
+    out << "    Colors Used: " << initial.colors_used << " -> " << final_coloring.colors_used << " (DSATUR from scratch: "
+        << colorGraph(final_graph, Algorithm::DSATUR).colors_used << "), "
+        << countColoringConflicts(final_graph, final_coloring.colors) << " conflicts";
+    return out.str();
+}
 
-        // Step 2: The selected vertex is colored with active color.
-        v_i->color = current_color;
-        total_colored_vertices++;
-        
-        // U set: Neighbors of the current color class members (cannot take active color)
-        // V_prime: Uncolored vertices NOT adjacent to any in the current color class (can potentially take active color)
-        std::vector<bool> forbidden_for_current_color(num_vertices + 1, false); 
-        
-        // Initialize forbidden set U with neighbors of v_i
-        for (int neighbor_id : v_i->neighbors) {
-            forbidden_for_current_color[neighbor_id] = true;
+// --- Batch coloring service (--serve) ---
+
+#ifdef __linux__
+// Parses a flat JSON object such as {"graph": "a.col", "budget_ms": 500, "colors": true}
+// into name -> value, keeping strings unescaped and other values (numbers, true, false,
+// null) as written. Nested objects and arrays are rejected. Returns false with a message.
+bool parseFlatJsonObject(const std::string& text, std::map<std::string, std::string>& fields, std::string& error) {
+    size_t pos = 0;
+    auto skip_spaces = [&]() {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+            ++pos;
+        }
+    };
+    auto parse_string = [&](std::string& out) {
+        if (pos >= text.size() || text[pos] != '"') {
+            return false;
+        }
+        for (++pos; pos < text.size() && text[pos] != '"'; ++pos) {
+            if (text[pos] != '\\') {
+                out += text[pos];
+                continue;
+            }
+            if (++pos >= text.size()) {
+                return false;
+            }
+            switch (text[pos]) {
+            case 'n': out += '\n'; break;
+            case 't': out += '\t'; break;
+            case 'r': out += '\r'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'u': {
+                // Basic multilingual plane only, encoded as UTF-8
+                if (pos + 4 >= text.size()) {
+                    return false;
+                }
+                unsigned code = static_cast<unsigned>(std::strtoul(text.substr(pos + 1, 4).c_str(), nullptr, 16));
+                pos += 4;
+                if (code < 0x80) {
+                    out += static_cast<char>(code);
+                } else if (code < 0x800) {
+                    out += static_cast<char>(0xC0 | (code >> 6));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                } else {
+                    out += static_cast<char>(0xE0 | (code >> 12));
+                    out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                break;
+            }
+            default: out += text[pos]; break; // \" \\ \/
+            }
+        }
+        if (pos >= text.size()) {
+            return false;
         }
+        ++pos; // Closing quote
+        return true;
+    };
 
-        // Inner loop: Recursively select uncolored vertices for the current color class
+    skip_spaces();
+    if (pos >= text.size() || text[pos] != '{') {
+        error = "expected a JSON object";
+        return false;
+    }
+    ++pos;
+    skip_spaces();
+    if (pos < text.size() && text[pos] == '}') {
+        ++pos;
+    } else {
         while (true) {
-            Vertex* v_j_candidate = nullptr; // The next vertex to add to current color class
-            int max_adj_in_U = -1;
-
-            // Iterate through all vertices to find candidates for V' and calculate heuristic
-            for (int k = 1; k <= num_vertices; ++k) {
-                if (vertices[k].color == -1 && !forbidden_for_current_color[k]) { // Is uncolored AND not forbidden (in V')
-                    // Calculate number of adjacent vertices which are in the set of U for every vertex in set of V'
-                    int current_adj_in_U = 0;
-                    for (int neighbor_of_vk : vertices[k].neighbors) {
-                        if (forbidden_for_current_color[neighbor_of_vk]) { // If neighbor is in U (forbidden set)
-                            current_adj_in_U++;
-                        }
-                    }
-                    vertices[k].heuristic_value = current_adj_in_U; // Store for selection
-
-                    // Select the uncolored vertex whose has maximum adjacent vertices (which are in the set of U) in the set of V'
-                    // If more than one vertex provide this condition, the vertex which has the largest degree among them is selected.
-                    if (v_j_candidate == nullptr || 
-                        vertices[k].heuristic_value > max_adj_in_U ||
-                        (vertices[k].heuristic_value == max_adj_in_U && vertices[k].degree > v_j_candidate->degree)) {
-                        
-                        max_adj_in_U = vertices[k].heuristic_value;
-                        v_j_candidate = &vertices[k];
-                    }
+            std::string name;
+            skip_spaces();
+            if (!parse_string(name)) {
+                error = "expected a quoted field name";
+                return false;
+            }
+            skip_spaces();
+            if (pos >= text.size() || text[pos] != ':') {
+                error = "expected ':' after \"" + name + "\"";
+                return false;
+            }
+            ++pos;
+            skip_spaces();
+            std::string value;
+            if (pos < text.size() && text[pos] == '"') {
+                if (!parse_string(value)) {
+                    error = "unterminated string in \"" + name + "\"";
+                    return false;
+                }
+            } else {
+                size_t end = pos;
+                while (end < text.size() && text[end] != ',' && text[end] != '}' && !std::isspace(static_cast<unsigned char>(text[end]))) {
+                    ++end;
+                }
+                value = text.substr(pos, end - pos);
+                if (value.empty() || value[0] == '{' || value[0] == '[') {
+                    error = "unsupported value for \"" + name + "\"";
+                    return false;
                 }
+                pos = end;
             }
-
-            if (v_j_candidate == nullptr) {
-                // Set V' is empty or no more eligible vertices for this color
-                break; // Move to Step 3 (next color)
+            fields[name] = value;
+            skip_spaces();
+            if (pos < text.size() && text[pos] == ',') {
+                ++pos;
+            } else if (pos < text.size() && text[pos] == '}') {
+                ++pos;
+                break;
+            } else {
+                error = "expected ',' or '}'";
+                return false;
             }
+        }
+    }
+    skip_spaces();
+    if (pos != text.size()) {
+        error = "trailing characters after the object";
+        return false;
+    }
+    return true;
+}
 
-            // The selected vertex is colored with active color.
-            v_j_candidate->color = current_color;
-            total_colored_vertices++;
+// Parses a whole request field as a finite number of at least 0. Returns false otherwise.
+bool parseNonNegativeNumber(const std::string& text, double& value) {
+    char* end = nullptr;
+    errno = 0;
+    value = std::strtod(text.c_str(), &end);
+    return !text.empty() && end == text.c_str() + text.size() && errno == 0 && std::isfinite(value) && value >= 0.0;
+}
 
-            // Update forbidden set U: Add adjacent vertices of the colored vertex to U
-            for (int neighbor_id : v_j_candidate->neighbors) {
-                forbidden_for_current_color[neighbor_id] = true;
-            }
-            // The colored vertex and its neighbors (which are now in U) are implicitly handled.
-            // No explicit deletion from V' is needed if we re-evaluate V' candidates in each iteration.
+// Parses a whole request field as an unsigned 64-bit integer. strtoull alone would accept
+// a sign and wrap "-5" around. Returns false otherwise.
+bool parseUnsignedInteger(const std::string& text, unsigned long long& value) {
+    char* end = nullptr;
+    errno = 0;
+    value = std::strtoull(text.c_str(), &end, 10);
+    return !text.empty() && std::isdigit(static_cast<unsigned char>(text[0])) && end == text.c_str() + text.size() &&
+           errno == 0;
+}
+
+// Quoted and escaped JSON string
+std::string jsonString(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += c;
         }
-        
-        // Step 3: If uncolored vertex exists, next color in the color set is selected as active.
-        current_color++; // Prepare for the next color class
     }
+    return out + "\"";
+}
 
-    // After loop, current_color holds the total number of colors used (since it increments one last time).
-    return current_color; 
+// JSON fields with the counters of a graph cache
+std::string formatGraphCacheJson(const GraphCacheStats& stats) {
+    std::ostringstream out;
+    out << "\"cache_hits\":" << stats.hits << ",\"cache_misses\":" << stats.misses << ",\"cache_evictions\":" << stats.evictions
+        << ",\"graphs_cached\":" << stats.graphs << ",\"cache_bytes\":" << stats.bytes << ",\"cache_budget_bytes\":" << stats.byte_budget;
+    return out.str();
 }
 
-// Implementation of the First Fit Graph Coloring Algorithm
-int FirstFit_coloring(std::vector<Vertex>& vertices, int num_vertices) {
-    // Reset all vertex colors at the start of First Fit run
-    for (int i = 1; i <= num_vertices; ++i) {
-        vertices[i].color = -1;
+// Latencies of the most recent requests and their percentiles
+class LatencyRecorder {
+public:
+    static const size_t kMaxSamples = 100000; // Older samples are overwritten
+
+    void record(double milliseconds) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (samples_.size() < kMaxSamples) {
+            samples_.push_back(milliseconds);
+        } else {
+            samples_[next_] = milliseconds;
+            next_ = (next_ + 1) % kMaxSamples;
+        }
+        ++count_;
     }
 
-    // Assign the first color to the first vertex (color 0)
-    vertices[1].color = 0;
-    int max_color_used = 0;
+    // JSON object with the sample count and the p50, p90, p99 and max latency in ms
+    std::string formatJson() const {
+        std::vector<double> sorted;
+        long long count;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            sorted = samples_;
+            count = count_;
+        }
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&](double p) {
+            // Nearest rank
+            size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+            return sorted.empty() ? 0.0 : sorted[std::max<size_t>(rank, 1) - 1];
+        };
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(3);
+        out << "{\"requests\":" << count << ",\"samples\":" << sorted.size() << ",\"p50\":" << percentile(50)
+            << ",\"p90\":" << percentile(90) << ",\"p99\":" << percentile(99)
+            << ",\"max\":" << (sorted.empty() ? 0.0 : sorted.back()) << "}";
+        return out.str();
+    }
 
-    // Iterate through the remaining vertices
-    for (int u = 2; u <= num_vertices; ++u) {
-        // Create a boolean array to keep track of available colors for vertex u
-        // availableColors[i] = true if color i is available, false otherwise
-        std::vector<bool> available_colors(num_vertices, true); 
+private:
+    mutable std::mutex mutex_;
+    std::vector<double> samples_;
+    size_t next_ = 0; // Oldest sample once the buffer is full
+    long long count_ = 0;
+};
 
-        // Check colors of adjacent vertices and mark them as unavailable
-        for (int neighbor_id : vertices[u].neighbors) {
-            if (vertices[neighbor_id].color != -1) {
-                available_colors[vertices[neighbor_id].color] = false;
-            }
+// Long-running coloring service on a Unix domain socket. Clients send one JSON object
+// per line and get one JSON object per line back, in order. Connections are handed to a
+// pool of worker threads, each serving one connection at a time, so concurrent clients
+// (or one client with several connections) are served in parallel.
+class ColoringServer {
+public:
+    // Graphs are loaded through cache, which must outlive the server. HEA requests start
+    // from hea_options (population, TabuCol moves, threads, memory limit).
+    ColoringServer(int num_threads, const ColoringOptions& coloring_options, const HEAOptions& hea_options,
+                   GraphCache& cache, GraphFormat format, int load_threads)
+        : num_threads_(num_threads), coloring_options_(coloring_options), hea_options_(hea_options), cache_(cache),
+          format_(format), load_threads_(load_threads) {
+        hea_options_.coloring = coloring_options;
+    }
+
+    // Serves until a shutdown request. Returns the process exit code.
+    int run(const std::string& socket_path) {
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (socket_path.size() >= sizeof(address.sun_path)) {
+            std::cerr << "Error: Socket path '" << socket_path << "' is too long" << std::endl;
+            return 1;
+        }
+        std::strcpy(address.sun_path, socket_path.c_str());
+
+        listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listen_fd_ < 0) {
+            std::cerr << "Error: Could not create socket: " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+        struct stat existing;
+        if (lstat(socket_path.c_str(), &existing) == 0 && S_ISSOCK(existing.st_mode)) {
+            unlink(socket_path.c_str()); // Left behind by a server that did not shut down
+        }
+        if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listen_fd_, 128) != 0) {
+            std::cerr << "Error: Could not listen on '" << socket_path << "': " << std::strerror(errno) << std::endl;
+            close(listen_fd_);
+            return 1;
+        }
+
+        std::cout << "Serving on '" << socket_path << "' with " << num_threads_ << " worker"
+                  << (num_threads_ > 1 ? "s" : "") << std::endl;
+        start_time_ = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (int t = 0; t < num_threads_; ++t) {
+            workers.emplace_back([this]() { workerLoop(); });
         }
 
-        // Find the smallest available color
-        int color;
-        for (color = 0; color < num_vertices; ++color) {
-            if (available_colors[color]) {
+        while (true) {
+            int connection_fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (connection_fd < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break; // shutdown() of the listening socket, or a fatal error
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) {
+                close(connection_fd);
                 break;
             }
+            pending_.push_back(connection_fd);
+            work_available_.notify_one();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+            for (int fd : pending_) {
+                close(fd);
+            }
+            pending_.clear();
+            work_available_.notify_all();
         }
-        
-        vertices[u].color = color; // Assign the found color to vertex u
-        
-        // Update max color used
-        if (color > max_color_used) {
-            max_color_used = color;
+        for (std::thread& worker : workers) {
+            worker.join();
         }
+        close(listen_fd_);
+        unlink(socket_path.c_str());
+        std::cout << "Server stopped: " << latencies_.formatJson() << std::endl;
+        return 0;
     }
 
-    return max_color_used + 1; // Return the total number of colors used (colors are 0-indexed)
-}
+private:
+    void workerLoop() {
+        while (true) {
+            int connection_fd;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                work_available_.wait(lock, [this]() { return stopping_ || !pending_.empty(); });
+                if (pending_.empty()) {
+                    return; // Stopping
+                }
+                connection_fd = pending_.front();
+                pending_.pop_front();
+                active_.push_back(connection_fd);
+            }
+            serveConnection(connection_fd);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                active_.erase(std::find(active_.begin(), active_.end(), connection_fd));
+            }
+            close(connection_fd);
+        }
+    }
 
-// Implementation of the Welsh-Powell Graph Coloring Algorithm
-int WelshPowell_coloring(std::vector<Vertex>& vertices, int num_vertices) {
-    // Reset all vertex colors at the start of Welsh-Powell run
-    for (int i = 1; i <= num_vertices; ++i) {
-        vertices[i].color = -1;
-    }
-
-    std::vector<bool> colored(num_vertices + 1, false); // To control which vertices have been colored
-    int current_color = 0;
-
-    while (true) {
-        bool all_colored = true;
-        std::vector<int> current_group; // Vertices that will receive the current_color
-
-        // Find the first uncolored vertex with the highest degree
-        int start_vertex = -1;
-        int max_degree = -1;
-        
-        for (int i = 1; i <= num_vertices; ++i) {
-            if (!colored[i] && vertices[i].degree > max_degree) {
-                start_vertex = i;
-                max_degree = vertices[i].degree;
-                all_colored = false;
-            }
-        }
-
-        if (all_colored) {
-            break; // All vertices have been colored
-        }
-
-        // Assign current_color to start_vertex and add it to the group
-        vertices[start_vertex].color = current_color;
-        colored[start_vertex] = true;
-        current_group.push_back(start_vertex);
-
-        // Go through uncolored vertices (in order of degree)
-        // Create a list of vertices sorted by degree for this iteration
-        std::vector<std::pair<int, int>> vertex_degree_pairs; // (vertex_id, degree)
-        for (int i = 1; i <= num_vertices; ++i) {
-            if (!colored[i]) {
-                vertex_degree_pairs.push_back({i, vertices[i].degree});
-            }
-        }
-        
-        // Sort by degree in descending order
-        std::sort(vertex_degree_pairs.begin(), vertex_degree_pairs.end(),
-                  [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
-                      return a.second > b.second;
-                  });
-
-        // Check each uncolored vertex
-        for (const auto& vd_candidate : vertex_degree_pairs) {
-            int candidate_vertex = vd_candidate.first;
-            if (!colored[candidate_vertex]) {
-                bool can_assign_color = true;
-                
-                // Check if candidate_vertex is adjacent to any vertex in current_group
-                for (int colored_vertex_in_group : current_group) {
-                    // Check if candidate_vertex is adjacent to colored_vertex_in_group
-                    bool is_adjacent = false;
-                    for (int neighbor_id : vertices[candidate_vertex].neighbors) {
-                        if (neighbor_id == colored_vertex_in_group) {
-                            is_adjacent = true;
-                            break;
-                        }
-                    }
-                    if (is_adjacent) {
-                        can_assign_color = false;
-                        break;
-                    }
+    // Answers every line of a connection until the client closes it
+    void serveConnection(int connection_fd) {
+        std::string buffer;
+        char chunk[65536];
+        while (true) {
+            size_t newline;
+            while ((newline = buffer.find('\n')) != std::string::npos) {
+                auto start_time = std::chrono::steady_clock::now();
+                std::string line = buffer.substr(0, newline);
+                buffer.erase(0, newline + 1);
+                if (!line.empty() && line.back() == '\r') {
+                    line.pop_back();
+                }
+                if (line.find_first_not_of(" \t") == std::string::npos) {
+                    continue;
                 }
-                
-                if (can_assign_color) {
-                    // If not adjacent, assign the same color and add to group
-                    vertices[candidate_vertex].color = current_color;
-                    colored[candidate_vertex] = true;
-                    current_group.push_back(candidate_vertex);
+                bool is_coloring = false;
+                std::string response = handleRequest(line, is_coloring) + "\n";
+                if (!sendAll(connection_fd, response)) {
+                    return;
                 }
+                if (is_coloring) {
+                    latencies_.record(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count());
+                }
+            }
+            ssize_t received = recv(connection_fd, chunk, sizeof(chunk), 0);
+            if (received < 0 && errno == EINTR) {
+                continue;
             }
+            if (received <= 0) {
+                return;
+            }
+            buffer.append(chunk, static_cast<size_t>(received));
         }
-        current_color++; // Move to the next color
     }
 
-    return current_color; // Return the total number of colors used
-}
+    static bool sendAll(int fd, const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
 
-// Implementation of the Largest Degree Ordering (LDO) Graph Coloring Algorithm
-int LargestDegreeOrdering_coloring(std::vector<Vertex>& vertices, int num_vertices) {
-    // Reset all vertex colors at the start of LDO run
-    for (int i = 1; i <= num_vertices; ++i) {
-        vertices[i].color = -1;
+    static std::string errorResponse(const std::string& message) {
+        return "{\"ok\":false,\"error\":" + jsonString(message) + "}";
     }
 
-    // Create a list of vertices sorted by degree in descending order
-    std::vector<std::pair<int, int>> vertex_degree_pairs; // (vertex_id, degree)
-    for (int i = 1; i <= num_vertices; ++i) {
-        vertex_degree_pairs.push_back({i, vertices[i].degree});
+    // Stops accepting connections; open ones are answered up to their current request
+    void requestShutdown() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        shutdown(listen_fd_, SHUT_RDWR); // Wakes up accept()
+        for (int fd : active_) {
+            shutdown(fd, SHUT_RD);
+        }
+        work_available_.notify_all();
     }
-    
-    // Sort by degree in descending order
-    std::sort(vertex_degree_pairs.begin(), vertex_degree_pairs.end(),
-              [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
-                  return a.second > b.second;
-              });
 
-    int max_color_used = -1;
+    std::string handleRequest(const std::string& line, bool& is_coloring) {
+        std::map<std::string, std::string> fields;
+        std::string error;
+        if (!parseFlatJsonObject(line, fields, error)) {
+            ++errors_;
+            return errorResponse("invalid request: " + error);
+        }
+        std::string command = fields.count("command") ? fields["command"] : "color";
+        if (command == "stats") {
+            std::ostringstream out;
+            out << std::fixed << std::setprecision(3);
+            out << "{\"ok\":true,\"uptime_s\":"
+                << std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count()
+                << ",\"workers\":" << num_threads_ << ",\"errors\":" << errors_ << "," << formatGraphCacheJson(cache_.stats())
+                << ",\"latency_ms\":" << latencies_.formatJson() << "}";
+            return out.str();
+        }
+        if (command == "shutdown") {
+            requestShutdown();
+            return "{\"ok\":true}";
+        }
+        if (command != "color") {
+            ++errors_;
+            return errorResponse("unknown command '" + command + "'");
+        }
 
-    // Color vertices in the order determined by degree
-    for (const auto& vd : vertex_degree_pairs) {
-        int u = vd.first; // The vertex to be colored
+        is_coloring = true;
+        if (!fields.count("graph")) {
+            ++errors_;
+            return errorResponse("missing \"graph\"");
+        }
+        std::string algorithm_name = fields.count("algorithm") ? fields["algorithm"] : "DSATUR";
+        Algorithm algorithm = Algorithm::DSATUR;
+        bool use_hea = algorithm_name == "HEA";
+        if (!use_hea && !parseAlgorithm(algorithm_name, algorithm)) {
+            ++errors_;
+            return errorResponse("unknown algorithm '" + algorithm_name + "'");
+        }
+        double budget_ms = 0.0;
+        if (fields.count("budget_ms") && !parseNonNegativeNumber(fields["budget_ms"], budget_ms)) {
+            ++errors_;
+            return errorResponse("\"budget_ms\" must be a number of milliseconds, 0 or more");
+        }
+        unsigned long long seed = 0;
+        bool has_seed = fields.count("seed") > 0;
+        if (has_seed && !parseUnsignedInteger(fields["seed"], seed)) {
+            ++errors_;
+            return errorResponse("\"seed\" must be an integer, 0 or more");
+        }
+        if (fields.count("colors") && fields["colors"] != "true" && fields["colors"] != "false") {
+            ++errors_;
+            return errorResponse("\"colors\" must be true or false");
+        }
+        bool return_colors = fields.count("colors") && fields["colors"] == "true";
+        // The improvement pass is explicit, so a greedy request always gets its algorithm's coloring
+        std::string improve = fields.count("improve") ? fields["improve"] : "none";
+        if (improve != "none" && improve != "iterated-greedy" && improve != "kempe") {
+            ++errors_;
+            return errorResponse("unknown improve pass '" + improve + "', use none, iterated-greedy or kempe");
+        }
+        if (use_hea && improve != "none") {
+            ++errors_;
+            return errorResponse("\"improve\" does not apply to HEA, whose \"budget_ms\" is its own time budget");
+        }
+        if (!use_hea && improve == "none" && budget_ms > 0.0) {
+            ++errors_;
+            return errorResponse("\"budget_ms\" needs an \"improve\" pass for a greedy algorithm");
+        }
 
-        // Vector to track available colors for vertex u
-        // availableColors[i] = true if color i is available, false otherwise
-        std::vector<bool> available_colors(num_vertices, true);
+        CachedGraph lookup = cache_.load(fields["graph"], format_, load_threads_);
+        if (!lookup.graph) {
+            ++errors_;
+            return errorResponse(lookup.error);
+        }
+        const Graph& graph = *lookup.graph;
 
-        // Check colors of u's neighbors that are already colored
-        for (int neighbor_id : vertices[u].neighbors) {
-            if (vertices[neighbor_id].color != -1) { // If neighbor is already colored
-                available_colors[vertices[neighbor_id].color] = false; // Mark neighbor's color as unavailable for u
+        ColoringResult result;
+        if (use_hea) {
+            HEAOptions hea_options = hea_options_;
+            if (budget_ms > 0.0) {
+                hea_options.time_budget_ms = budget_ms;
+            }
+            if (has_seed) {
+                hea_options.seed = seed;
+            }
+            HEAResult hea_result = runHybridEvolutionary(graph, hea_options);
+            result = std::move(hea_result.coloring);
+            result.elapsed_ms = hea_result.elapsed_ms;
+        } else {
+            ColoringOptions options = coloring_options_;
+            if (has_seed) {
+                options.randomize = true;
+                options.seed = seed;
+            }
+            result = colorGraph(graph, algorithm, options);
+            if (improve == "iterated-greedy") {
+                IteratedGreedyOptions iterated_greedy;
+                if (budget_ms > 0.0) {
+                    iterated_greedy.time_budget_ms = budget_ms;
+                }
+                iterated_greedy.seed = options.seed;
+                result = std::move(iteratedGreedy(graph, result, iterated_greedy).coloring);
+            } else if (improve == "kempe") {
+                KempeReductionOptions kempe;
+                if (budget_ms > 0.0) {
+                    kempe.time_budget_ms = budget_ms;
+                }
+                result = std::move(reduceColorsByKempeChains(graph, result, kempe).coloring);
             }
         }
 
-        // Find the smallest available color
-        int color;
-        for (color = 0; color < num_vertices; ++color) {
-            if (available_colors[color]) {
-                break;
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(3);
+        out << "{\"ok\":true,\"graph\":" << jsonString(fields["graph"]) << ",\"algorithm\":" << jsonString(algorithm_name)
+            << ",\"improve\":" << jsonString(improve)
+            << ",\"vertices\":" << graph.numVertices() << ",\"edges\":" << graph.numEdges()
+            << ",\"colors_used\":" << result.colors_used << ",\"elapsed_ms\":" << result.elapsed_ms
+            << ",\"cache\":\"" << (lookup.hit ? "hit" : "miss") << "\",\"load_ms\":" << lookup.load_ms;
+        if (return_colors) {
+            // 1-based colors of vertices 1..n, as in the DIMACS solution files
+            out << ",\"colors\":[";
+            for (int v = 1; v <= graph.numVertices(); ++v) {
+                out << (v > 1 ? "," : "") << result.colors[v] + 1;
             }
+            out << "]";
         }
-        
-        vertices[u].color = color; // Assign the found color to vertex u
-        
-        // Update max color used
-        if (color > max_color_used) {
-            max_color_used = color;
-        }
+        out << "}";
+        return out.str();
     }
 
-    return max_color_used + 1; // Return the total number of colors used (colors are 0-indexed)
+    int num_threads_;
+    ColoringOptions coloring_options_;
+    HEAOptions hea_options_;
+    GraphCache& cache_;
+    GraphFormat format_;
+    int load_threads_;
+    LatencyRecorder latencies_;
+    std::chrono::steady_clock::time_point start_time_;
+    std::atomic<long long> errors_{0};
+
+    int listen_fd_ = -1;
+    std::mutex mutex_; // Guards the members below
+    std::condition_variable work_available_;
+    std::deque<int> pending_; // Accepted connections waiting for a worker
+    std::vector<int> active_; // Connections being served
+    bool stopping_ = false;
+};
+#endif
+
+// A graph processed by main(): either a file to read or a synthetic graph to generate
+struct GraphInput {
+    std::string name; // File path, or the generator spec name
+    bool generated = false;
+    GraphGeneratorSpec spec;
+};
+
+void printUsage(const char* program_name) {
+    std::cerr << "Usage: " << program_name << " [options] [graph files...]\n"
+              << "  Without graph files or generators, the DIMACS instances listed in main() are processed.\n"
+              << "Options:\n"
+              << "  --relabel <none|rcm|degree|bfs>  Renumber vertices after load for cache locality\n"
+              << "  --compress-adjacency             Store the neighbor lists as delta coded rows (after --relabel)\n"
+              << "  --algorithms <A,B,...>           Run only these algorithms (FF, WP, LDO, IDO, DSATUR, RLF,\n"
+              << "                                   and the variants IDO-SAT, DSATUR-UD)\n"
+              << "  --write-colorings <folder>       Write each coloring in DIMACS solution format (original IDs)\n"
+              << "  --legacy-tie-break               Break IDO/DSATUR ties in the initial degree order, as originally\n"
+              << "  --saturation-memory-limit <MiB>  Cap on the DSATUR saturation bitsets, sets are used above it (default 256)\n"
+              << "  --seeds <N>                      Run each algorithm with N random tie-breaking seeds, keep the best\n"
+              << "  --seed <S>                       First seed of --seeds, seed of --iterated-greedy (default 1)\n"
+              << "  --seed-threads <N>               Threads sharing the seeds (0 = all cores, default 1)\n"
+              << "  --kempe                          Try to empty the smallest color classes by Kempe chain swaps\n"
+              << "  --kempe-budget <ms>              Time budget of --kempe per coloring (default 1000)\n"
+              << "  --iterated-greedy <ms>           Improve each coloring by Iterated Greedy for the given time\n"
+              << "  --iterated-greedy-orders <O,...> Class orders it picks from: reverse, largest, random, degree-sum\n"
+              << "  --hea <ms>                       Also run the hybrid evolutionary algorithm (GPX + TabuCol) for the given time\n"
+              << "  --hea-population <N>             Population size (default 10)\n"
+              << "  --hea-tabu-iterations <N>        TabuCol moves per new individual (default 10000)\n"
+              << "  --hea-threads <N>                Individuals improved in parallel (0 = all cores, default 1)\n"
+              << "  --hea-memory-limit <MiB>         Cap on the TabuCol tables of all HEA threads, fewer threads above it (default 1024)\n"
+              << "  --partialcol <k>                 Also look for a legal k-coloring with PartialCol tabu search\n"
+              << "  --partialcol-budget <ms>         Time budget of --partialcol (default 10000)\n"
+              << "  --partialcol-init <A>            Greedy algorithm whose coloring, truncated to k colors, is the start\n"
+              << "                                   (default DSATUR)\n"
+              << "  --dynamic-updates <N>            Also apply N random edge/vertex updates to a dynamic coloring\n"
+              << "  --graph-cache <MiB>              Keep loaded graphs for repeated inputs and requests (default 1024)\n"
+              << "  --serve <socket>                 Answer JSON coloring requests on a Unix domain socket instead\n"
+              << "  --serve-threads <N>              Server worker threads (0 = all cores, default 0)\n"
+              << "  --perf-counters                  Report cycles, instructions, LLC and branch misses per algorithm\n"
+              << "  --trace-json <file>              Export phase timings as Chrome trace events (build with -DGC_TRACE)\n"
+              << "  --format <auto|dimacs|dimacs-binary|metis|edgelist>\n"
+              << "                                   Input format of graph files (default: detected)\n"
+              << "  --load-threads <N>               Parse graph files with N threads (0 = all cores, default 1)\n"
+              << "  --memory-stats                   Report peak heap, allocations and RSS for loading and each algorithm\n"
+              << "  --generate <family:key=value,...> Color a synthetic graph (repeatable), families:\n"
+              << "                                   gnp:n,p,seed  geo:n,r,seed  leighton:n,k,m,seed  flat:n,k,p,seed\n";
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     // Define the folder where the graph files are located
     const std::string graph_folder = "DIMACS_Graphs_Instances/";
     const std::string log_filename = "results.log";
@@ -539,6 +1116,191 @@ int main() {
         "C4000.5.col",
     };
 
+    // Parse command line options
+    RelabelOrder relabel_order = RelabelOrder::None;
+    bool compress_adjacency = false;
+    std::string coloring_output_folder;
+    std::vector<Algorithm> algorithms = allAlgorithms();
+    std::vector<GraphInput> graph_inputs;
+    ColoringOptions coloring_options;
+    MultiStartOptions multi_start;
+    multi_start.num_seeds = 0; // Single deterministic run unless --seeds is given
+    bool use_kempe = false;
+    KempeReductionOptions kempe_options;
+    bool use_iterated_greedy = false;
+    bool use_hea = false;
+    long long dynamic_updates = 0;
+    int partialcol_colors = 0; // --partialcol k, 0 when not requested
+    PartialColOptions partialcol_options;
+    HEAOptions hea_options;
+    IteratedGreedyOptions iterated_greedy;
+    bool use_perf_counters = false;
+    bool report_memory = false;
+    int load_threads = 1;
+    GraphFormat input_format = GraphFormat::Auto;
+    std::string trace_json_filename;
+    std::string serve_socket;
+    int serve_threads = 0;
+    size_t graph_cache_budget = size_t(1024) << 20;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--relabel" && has_value) {
+            if (!parseRelabelOrder(argv[++i], relabel_order)) {
+                std::cerr << "Error: Unknown relabeling order '" << argv[i] << "'" << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--compress-adjacency") {
+            compress_adjacency = true;
+        } else if (arg == "--algorithms" && has_value) {
+            algorithms.clear();
+            std::istringstream names(argv[++i]);
+            std::string name;
+            while (std::getline(names, name, ',')) {
+                Algorithm algorithm;
+                if (!parseAlgorithm(name, algorithm)) {
+                    std::cerr << "Error: Unknown algorithm '" << name << "'" << std::endl;
+                    printUsage(argv[0]);
+                    return 1;
+                }
+                algorithms.push_back(algorithm);
+            }
+        } else if (arg == "--write-colorings" && has_value) {
+            coloring_output_folder = argv[++i];
+            if (coloring_output_folder.back() != '/') {
+                coloring_output_folder += '/';
+            }
+        } else if (arg == "--legacy-tie-break") {
+            coloring_options.legacy_tie_break = true;
+        } else if (arg == "--saturation-memory-limit" && has_value) {
+            coloring_options.saturation_memory_limit = static_cast<size_t>(std::max(0L, std::atol(argv[++i]))) << 20;
+        } else if (arg == "--seeds" && has_value) {
+            multi_start.num_seeds = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--seed" && has_value) {
+            multi_start.first_seed = std::strtoull(argv[++i], nullptr, 10);
+            iterated_greedy.seed = multi_start.first_seed;
+            hea_options.seed = multi_start.first_seed;
+            partialcol_options.seed = multi_start.first_seed;
+        } else if (arg == "--seed-threads" && has_value) {
+            multi_start.num_threads = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--kempe") {
+            use_kempe = true;
+        } else if (arg == "--kempe-budget" && has_value) {
+            kempe_options.time_budget_ms = std::atof(argv[++i]);
+        } else if (arg == "--iterated-greedy" && has_value) {
+            use_iterated_greedy = true;
+            iterated_greedy.time_budget_ms = std::atof(argv[++i]);
+        } else if (arg == "--iterated-greedy-orders" && has_value) {
+            iterated_greedy.orders.clear();
+            std::istringstream names(argv[++i]);
+            std::string name;
+            while (std::getline(names, name, ',')) {
+                ClassOrder order;
+                if (!parseClassOrder(name, order)) {
+                    std::cerr << "Error: Unknown class order '" << name << "'" << std::endl;
+                    printUsage(argv[0]);
+                    return 1;
+                }
+                iterated_greedy.orders.push_back(order);
+            }
+        } else if (arg == "--dynamic-updates" && has_value) {
+            dynamic_updates = std::max(0LL, std::atoll(argv[++i]));
+        } else if (arg == "--hea" && has_value) {
+            use_hea = true;
+            hea_options.time_budget_ms = std::atof(argv[++i]);
+        } else if (arg == "--hea-population" && has_value) {
+            hea_options.population_size = std::max(2, std::atoi(argv[++i]));
+        } else if (arg == "--hea-tabu-iterations" && has_value) {
+            hea_options.tabu_iterations = std::max(1LL, std::atoll(argv[++i]));
+        } else if (arg == "--hea-threads" && has_value) {
+            hea_options.num_threads = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--hea-memory-limit" && has_value) {
+            hea_options.tabu_memory_limit = static_cast<size_t>(std::max(0L, std::atol(argv[++i]))) << 20;
+        } else if (arg == "--partialcol" && has_value) {
+            partialcol_colors = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--partialcol-budget" && has_value) {
+            partialcol_options.time_budget_ms = std::atof(argv[++i]);
+        } else if (arg == "--partialcol-init" && has_value) {
+            if (!parseAlgorithm(argv[++i], partialcol_options.initial_algorithm)) {
+                std::cerr << "Error: Unknown algorithm '" << argv[i] << "'" << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--graph-cache" && has_value) {
+            graph_cache_budget = static_cast<size_t>(std::max(0L, std::atol(argv[++i]))) << 20;
+        } else if (arg == "--serve" && has_value) {
+            serve_socket = argv[++i];
+        } else if (arg == "--serve-threads" && has_value) {
+            serve_threads = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--perf-counters") {
+            use_perf_counters = true;
+        } else if (arg == "--format" && has_value) {
+            if (!parseGraphFormat(argv[++i], input_format)) {
+                std::cerr << "Error: Unknown graph format '" << argv[i] << "'" << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--load-threads" && has_value) {
+            load_threads = std::atoi(argv[++i]);
+            if (load_threads <= 0) {
+                load_threads = std::max(1u, std::thread::hardware_concurrency());
+            }
+        } else if (arg == "--memory-stats") {
+            report_memory = true;
+        } else if (arg == "--trace-json" && has_value) {
+            trace_json_filename = argv[++i];
+#ifndef GC_TRACE
+            std::cerr << "Error: --trace-json requires a build with -DGC_TRACE" << std::endl;
+            return 1;
+#endif
+        } else if (arg == "--generate" && has_value) {
+            GraphInput input;
+            if (!parseGeneratorSpec(argv[++i], input.spec)) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            input.name = generatorSpecName(input.spec);
+            input.generated = true;
+            graph_inputs.push_back(input);
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "Error: Unknown or incomplete option '" << arg << "'" << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            GraphInput input;
+            input.name = arg;
+            graph_inputs.push_back(input);
+        }
+    }
+
+    if (!serve_socket.empty()) {
+#ifdef __linux__
+        if (serve_threads == 0) {
+            serve_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        }
+        GraphCache server_cache(graph_cache_budget);
+        ColoringServer server(serve_threads, coloring_options, hea_options, server_cache, input_format, load_threads);
+        return server.run(serve_socket);
+#else
+        std::cerr << "Error: --serve is only available on Linux" << std::endl;
+        return 1;
+#endif
+    }
+
+    if (graph_inputs.empty()) {
+        for (const std::string& filename : filenames) {
+            // Construct the full path to the graph file
+            GraphInput input;
+            input.name = graph_folder + filename;
+            graph_inputs.push_back(input);
+        }
+    }
+
     std::ofstream log_file(log_filename, std::ios_base::app);
     if (!log_file.is_open()) {
         std::cerr << "Error: Could not open log file '" << log_filename << "'" << std::endl;
@@ -548,107 +1310,251 @@ int main() {
     log_file << "--- Graph Coloring Algorithms Comparison Session Start: " << std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()) << " ---" << std::endl;
     std::cout << "--- Graph Coloring Algorithms Comparison ---" << std::endl;
 
-    // A single vector to reuse for graph data to save memory,
-    // cleared and resized for each new graph.
-    std::vector<Vertex> vertices_storage;
-    int num_vertices_current = 0;
-    int num_edges_current = 0;
-
-    for (const std::string& filename : filenames) {
-        // Construct the full path to the graph file
-        std::string full_path_filename = graph_folder + filename;
-
-        std::cout << "\nProcessing graph file: '" << full_path_filename << "'" << std::endl;
-        log_file << "\nProcessing graph file: '" << full_path_filename << "'" << std::endl;
-
-        // Attempt to read the graph file
-        if (!readGraphFile(full_path_filename, vertices_storage, num_vertices_current, num_edges_current)) {
-            std::cerr << "Failed to read graph from '" << full_path_filename << "'. Skipping." << std::endl;
-            log_file << "Failed to read graph from '" << full_path_filename << "'. Skipping." << std::endl;
-            continue; // Move to the next file in the list
-        }
-
-        std::cout << "  Graph loaded: " << num_vertices_current << " vertices, " << num_edges_current << " edges." << std::endl;
-        log_file << "  Graph loaded: " << num_vertices_current << " vertices, " << num_edges_current << " edges." << std::endl;
-
-        // --- Run First Fit Algorithm ---
-        std::cout << "\n  Algorithm: FF" << std::endl;
-        log_file << "\n  Algorithm: FF" << std::endl;
-        auto start_time_firstfit = std::chrono::high_resolution_clock::now();
-        int colors_used_firstfit = FirstFit_coloring(vertices_storage, num_vertices_current);
-        auto end_time_firstfit = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double, std::milli> elapsed_milliseconds_firstfit = end_time_firstfit - start_time_firstfit;
-
-        std::cout << "    Colors Used: " << colors_used_firstfit << std::endl;
-        std::cout << "    CPU Time:    " << elapsed_milliseconds_firstfit.count() << " ms" << std::endl;
-        log_file << "    Colors Used: " << colors_used_firstfit << std::endl;
-        log_file << "    CPU Time:    " << elapsed_milliseconds_firstfit.count() << " ms" << std::endl;
-
-        // --- Run Welsh-Powell Algorithm ---
-        std::cout << "\n  Algorithm: WP" << std::endl;
-        log_file << "\n  Algorithm: WP" << std::endl;
-        auto start_time_welshpowell = std::chrono::high_resolution_clock::now();
-        int colors_used_welshpowell = WelshPowell_coloring(vertices_storage, num_vertices_current);
-        auto end_time_welshpowell = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double, std::milli> elapsed_milliseconds_welshpowell = end_time_welshpowell - start_time_welshpowell;
-        
-        std::cout << "    Colors Used: " << colors_used_welshpowell << std::endl;
-        std::cout << "    CPU Time:    " << elapsed_milliseconds_welshpowell.count() << " ms" << std::endl;
-        log_file << "    Colors Used: " << colors_used_welshpowell << std::endl;
-        log_file << "    CPU Time:    " << elapsed_milliseconds_welshpowell.count() << " ms" << std::endl;
-
-        // --- Run Largest Degree Ordering Algorithm ---
-        std::cout << "\n  Algorithm: LDO" << std::endl;
-        log_file << "\n  Algorithm: LDO" << std::endl;
-        auto start_time_ldo = std::chrono::high_resolution_clock::now();
-        int colors_used_ldo = LargestDegreeOrdering_coloring(vertices_storage, num_vertices_current);
-        auto end_time_ldo = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double, std::milli> elapsed_milliseconds_ldo = end_time_ldo - start_time_ldo;
-        
-        std::cout << "    Colors Used: " << colors_used_ldo << std::endl;
-        std::cout << "    CPU Time:    " << elapsed_milliseconds_ldo.count() << " ms" << std::endl;
-        log_file << "    Colors Used: " << colors_used_ldo << std::endl;
-        log_file << "    CPU Time:    " << elapsed_milliseconds_ldo.count() << " ms" << std::endl;
-
-        // --- Run IDO Algorithm ---
-        std::cout << "\n  Algorithm: IDO" << std::endl;
-        log_file << "\n  Algorithm: IDO" << std::endl;
-        auto start_time_ido = std::chrono::high_resolution_clock::now();
-        int colors_used_ido = IDO_coloring(vertices_storage, num_vertices_current);
-        auto end_time_ido = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double, std::milli> elapsed_milliseconds_ido = end_time_ido - start_time_ido;
-
-        std::cout << "    Colors Used: " << colors_used_ido << std::endl;
-        std::cout << "    CPU Time:    " << elapsed_milliseconds_ido.count() << " ms" << std::endl;
-        log_file << "    Colors Used: " << colors_used_ido << std::endl;
-        log_file << "    CPU Time:    " << elapsed_milliseconds_ido.count() << " ms" << std::endl;
-
-        // --- Run DSATUR Algorithm ---
-        std::cout << "\n  Algorithm: DSATUR" << std::endl;
-        log_file << "\n  Algorithm: DSATUR" << std::endl;
-        auto start_time_dsatur = std::chrono::high_resolution_clock::now();
-        int colors_used_dsatur = DSATUR_coloring(vertices_storage, num_vertices_current);
-        auto end_time_dsatur = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double, std::milli> elapsed_milliseconds_dsatur = end_time_dsatur - start_time_dsatur;
-
-        std::cout << "    Colors Used: " << colors_used_dsatur << std::endl;
-        std::cout << "    CPU Time:    " << elapsed_milliseconds_dsatur.count() << " ms" << std::endl;
-        log_file << "    Colors Used: " << colors_used_dsatur << std::endl;
-        log_file << "    CPU Time:    " << elapsed_milliseconds_dsatur.count() << " ms" << std::endl;
-
-        // --- Run RLF Algorithm ---
-        std::cout << "\n  Algorithm: RLF" << std::endl;
-        log_file << "\n  Algorithm: RLF" << std::endl;
-        auto start_time_rlf = std::chrono::high_resolution_clock::now();
-        int colors_used_rlf = RLF_coloring(vertices_storage, num_vertices_current);
-        auto end_time_rlf = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double, std::milli> elapsed_milliseconds_rlf = end_time_rlf - start_time_rlf;
-
-        std::cout << "    Colors Used: " << colors_used_rlf << std::endl;
-        std::cout << "    CPU Time:    " << elapsed_milliseconds_rlf.count() << " ms" << std::endl;
-        log_file << "    Colors Used: " << colors_used_rlf << std::endl;
-        log_file << "    CPU Time:    " << elapsed_milliseconds_rlf.count() << " ms" << std::endl;
+    // Hardware counters are opened once and reused for every algorithm run
+    PerfCounters perf_counters;
+    if (use_perf_counters && !perf_counters.available()) {
+        std::cerr << "Warning: Hardware performance counters unavailable (" << perf_counters.unavailableReason()
+                  << "). Reporting CPU time only." << std::endl;
+    }
+
+#ifdef GC_TRACE
+    if (!trace_json_filename.empty()) {
+        PhaseTracer::enableEvents(4000000); // Roughly 100 MB of events at most
+    }
+#endif
+
+    // Graphs given more than once (files or generator specs) are loaded once and shared
+    // from the cache; the others are evicted least recently used first to stay within
+    // the budget.
+    GraphCache graph_cache(graph_cache_budget);
+    std::vector<int> original_ids; // original_ids[i] = ID in the file of vertex i after relabeling
+
+    for (const GraphInput& input : graph_inputs) {
+        const std::string& full_path_filename = input.name;
+        MemoryMeasurement load_memory; // Covers reading or generating the graph
+        CachedGraph cached;
+        if (input.generated) {
+            std::cout << "\nGenerating graph: '" << input.name << "'" << std::endl;
+            log_file << "\nGenerating graph: '" << input.name << "'" << std::endl;
+
+            cached = graph_cache.generate(input.spec);
+            const Graph& generated = *cached.graph;
+
+            std::cout << "  Graph generated: " << generated.numVertices() << " vertices, " << generated.numEdges() << " edges in "
+                      << cached.load_ms << " ms." << std::endl;
+            log_file << "  Graph generated: " << generated.numVertices() << " vertices, " << generated.numEdges() << " edges in "
+                     << cached.load_ms << " ms." << std::endl;
+        } else {
+            std::cout << "\nProcessing graph file: '" << full_path_filename << "'" << std::endl;
+            log_file << "\nProcessing graph file: '" << full_path_filename << "'" << std::endl;
+
+            // Attempt to read the graph file, unless it is cached and unchanged
+            cached = graph_cache.load(full_path_filename, input_format, load_threads);
+            if (!cached.graph) {
+                if (!cached.error.empty()) {
+                    std::cerr << "Error: " << cached.error << std::endl;
+                }
+                std::cerr << "Failed to read graph from '" << full_path_filename << "'. Skipping." << std::endl;
+                log_file << "Failed to read graph from '" << full_path_filename << "'. Skipping." << std::endl;
+                continue; // Move to the next file in the list
+            }
+            const Graph& loaded = *cached.graph;
+            const GraphLoadStats& load_stats = cached.load_stats;
+
+            std::cout << "  Graph loaded: " << loaded.numVertices() << " vertices, " << loaded.numEdges() << " edges." << std::endl;
+            log_file << "  Graph loaded: " << loaded.numVertices() << " vertices, " << loaded.numEdges() << " edges." << std::endl;
+            std::cout << "  Load Time:   " << cached.load_ms << " ms (" << load_threads << " thread" << (load_threads > 1 ? "s" : "") << ")" << std::endl;
+            log_file << "  Load Time:   " << cached.load_ms << " ms (" << load_threads << " thread" << (load_threads > 1 ? "s" : "") << ")" << std::endl;
+
+            std::ostringstream edge_report;
+            edge_report << "  Simple graph: " << load_stats.simple_edges << " edges from " << load_stats.edge_lines << " edge lines ("
+                        << load_stats.duplicate_edges << " duplicates, " << load_stats.self_loops << " self-loops";
+            if (load_stats.invalid_edges > 0) {
+                edge_report << ", " << load_stats.invalid_edges << " invalid";
+            }
+            edge_report << " removed).";
+            std::cout << edge_report.str() << std::endl;
+            log_file << edge_report.str() << std::endl;
+        }
+        std::string cache_report = formatGraphCacheReport(cached.hit, graph_cache.stats());
+        std::cout << cache_report << std::endl;
+        log_file << cache_report << std::endl;
+        if (report_memory) {
+            std::string memory_report = formatMemoryReport("  Load Memory: ", load_memory.finish());
+            std::cout << memory_report << std::endl;
+            log_file << memory_report << std::endl;
+        }
+
+        // --- Optional relabeling pass for cache locality, and compression ---
+        // The cached graph is shared, so both work on a copy
+        Graph working_graph;
+        bool use_working_graph = relabel_order != RelabelOrder::None || compress_adjacency;
+        const Graph& graph = use_working_graph ? working_graph : *cached.graph;
+        if (use_working_graph) {
+            working_graph = *cached.graph;
+        }
+        if (relabel_order != RelabelOrder::None) {
+            NeighborLocality before = measureNeighborLocality(graph);
+            auto start_time_relabel = std::chrono::high_resolution_clock::now();
+            relabelGraph(working_graph, relabel_order, original_ids);
+            auto end_time_relabel = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double, std::milli> elapsed_milliseconds_relabel = end_time_relabel - start_time_relabel;
+            NeighborLocality after = measureNeighborLocality(graph);
+
+            std::ostringstream report;
+            report << "  Relabeled (" << relabelOrderName(relabel_order) << ") in " << elapsed_milliseconds_relabel.count() << " ms: "
+                   << "bandwidth " << before.bandwidth << " -> " << after.bandwidth
+                   << ", mean neighbor gap " << before.mean_gap << " -> " << after.mean_gap;
+            std::cout << report.str() << std::endl;
+            log_file << report.str() << std::endl;
+        } else {
+            original_ids.resize(graph.numVertices() + 1);
+            std::iota(original_ids.begin(), original_ids.end(), 0);
+        }
+        if (compress_adjacency) {
+            size_t csr_bytes = graphMemoryBytes(graph);
+            auto start_time_compress = std::chrono::steady_clock::now();
+            bool compressed = working_graph.compressAdjacency();
+            std::chrono::duration<double, std::milli> elapsed_compress = std::chrono::steady_clock::now() - start_time_compress;
+            if (compressed) {
+                size_t compressed_bytes = graphMemoryBytes(graph);
+                std::ostringstream report;
+                report << "  Compressed adjacency in " << elapsed_compress.count() << " ms: "
+                       << formatBytes(static_cast<long long>(csr_bytes)) << " -> "
+                       << formatBytes(static_cast<long long>(compressed_bytes)) << " (" << std::fixed << std::setprecision(2)
+                       << static_cast<double>(csr_bytes) / std::max<size_t>(1, compressed_bytes) << "x smaller)";
+                std::cout << report.str() << std::endl;
+                log_file << report.str() << std::endl;
+            }
+        }
+
+        ColoringResult result; // Reused by the runs, so that they allocate nothing once warmed up
+        for (Algorithm algorithm : algorithms) {
+            std::string algorithm_name = algorithmName(algorithm);
+            std::cout << "\n  Algorithm: " << algorithm_name << std::endl;
+            log_file << "\n  Algorithm: " << algorithm_name << std::endl;
+            MemoryMeasurement run_memory;
+            if (use_perf_counters) {
+                perf_counters.start();
+            }
+#ifdef GC_TRACE
+            PhaseTracer::current().resetTotals();
+#endif
+            MultiStartResult multi_start_result;
+            if (multi_start.num_seeds > 0) {
+                multi_start_result = runMultiStart(graph, algorithm, coloring_options, multi_start);
+                result = std::move(multi_start_result.best);
+                result.elapsed_ms = multi_start_result.elapsed_ms; // Wall time of all seeds
+            } else {
+                colorGraph(graph, algorithm, coloring_options, result);
+            }
+            PerfCounters::Reading perf_reading;
+            if (use_perf_counters) {
+                perf_reading = perf_counters.stop();
+            }
+            MemoryReport run_memory_report = run_memory.finish(); // The run itself, before any report is formatted
+
+            std::cout << "    Colors Used: " << result.colors_used << std::endl;
+            std::cout << "    CPU Time:    " << result.elapsed_ms << " ms" << std::endl;
+            log_file << "    Colors Used: " << result.colors_used << std::endl;
+            log_file << "    CPU Time:    " << result.elapsed_ms << " ms" << std::endl;
+            if (result.stats.saturation_bytes > 0 || result.stats.saturation_over_limit) {
+                std::string saturation_report = "    Saturation:  " + formatBytes(result.stats.saturation_bytes) + " of bitsets" +
+                                                (result.stats.saturation_over_limit ? ", over the limit, continued with sets" : "");
+                std::cout << saturation_report << std::endl;
+                log_file << saturation_report << std::endl;
+            }
+            if (multi_start.num_seeds > 0) {
+                std::string multi_start_report = formatMultiStartReport(multi_start_result, multi_start.first_seed);
+                std::cout << multi_start_report << std::endl;
+                log_file << multi_start_report << std::endl;
+            }
+            if (use_kempe) {
+                KempeReductionResult reduced = reduceColorsByKempeChains(graph, result, kempe_options);
+                std::string kempe_report = formatKempeReport(reduced);
+                std::cout << kempe_report << std::endl;
+                log_file << kempe_report << std::endl;
+                result = std::move(reduced.coloring); // Later passes and the written file use the reduced coloring
+            }
+            if (use_iterated_greedy) {
+                IteratedGreedyResult improved = iteratedGreedy(graph, result, iterated_greedy);
+                std::string iterated_greedy_report = formatIteratedGreedyReport(improved);
+                std::cout << iterated_greedy_report << std::endl;
+                log_file << iterated_greedy_report << std::endl;
+                result = std::move(improved.coloring); // The improved coloring is the one written below
+            }
+            if (use_perf_counters && perf_counters.available()) {
+                std::string perf_report = formatPerfReading(perf_reading);
+                std::cout << perf_report << std::endl;
+                log_file << perf_report << std::endl;
+            }
+            if (report_memory) {
+                std::string memory_report = formatMemoryReport("    Memory:      ", run_memory_report) + ", scratch arena " +
+                                            formatBytes(static_cast<long long>(scratchMemoryStats().reserved_bytes));
+                std::cout << memory_report << std::endl;
+                log_file << memory_report << std::endl;
+            }
+#ifdef GC_TRACE
+            PhaseTracer::current().recordRun(algorithm_name + " " + full_path_filename, result.elapsed_ms);
+            std::string phase_report = PhaseTracer::current().formatTotals();
+            std::cout << phase_report << std::endl;
+            log_file << phase_report << std::endl;
+#endif
+
+            if (!coloring_output_folder.empty()) {
+                std::string base_name = full_path_filename.substr(full_path_filename.find_last_of('/') + 1);
+                writeColoringFile(coloring_output_folder + base_name + "." + algorithm_name + ".sol", result, original_ids);
+            }
+        }
+
+        // --- Optional dynamic coloring benchmark ---
+        if (dynamic_updates > 0) {
+            std::cout << "\n  Dynamic coloring (from DSATUR):" << std::endl;
+            log_file << "\n  Dynamic coloring (from DSATUR):" << std::endl;
+            std::string dynamic_report = runDynamicBenchmark(graph, dynamic_updates, multi_start.first_seed);
+            std::cout << dynamic_report << std::endl;
+            log_file << dynamic_report << std::endl;
+        }
 
+        // --- Optional hybrid evolutionary search ---
+        if (use_hea) {
+            std::cout << "\n  Algorithm: HEA" << std::endl;
+            log_file << "\n  Algorithm: HEA" << std::endl;
+            hea_options.coloring = coloring_options;
+            HEAResult hea_result = runHybridEvolutionary(graph, hea_options);
+            std::cout << "    Colors Used: " << hea_result.coloring.colors_used << std::endl;
+            std::cout << "    CPU Time:    " << hea_result.elapsed_ms << " ms" << std::endl;
+            log_file << "    Colors Used: " << hea_result.coloring.colors_used << std::endl;
+            log_file << "    CPU Time:    " << hea_result.elapsed_ms << " ms" << std::endl;
+            std::string hea_report = formatHEAReport(hea_result, hea_options.population_size);
+            std::cout << hea_report << std::endl;
+            log_file << hea_report << std::endl;
+            if (!coloring_output_folder.empty()) {
+                std::string base_name = full_path_filename.substr(full_path_filename.find_last_of('/') + 1);
+                writeColoringFile(coloring_output_folder + base_name + ".HEA.sol", hea_result.coloring, original_ids);
+            }
+        }
+
+        // --- Optional search for a legal coloring with a fixed number of colors ---
+        if (partialcol_colors > 0) {
+            std::cout << "\n  Algorithm: PartialCol" << std::endl;
+            log_file << "\n  Algorithm: PartialCol" << std::endl;
+            PartialColResult partialcol_result = runPartialCol(graph, partialcol_colors, partialcol_options);
+            if (partialcol_result.success) {
+                std::cout << "    Colors Used: " << partialcol_result.coloring.colors_used << std::endl;
+                log_file << "    Colors Used: " << partialcol_result.coloring.colors_used << std::endl;
+            }
+            std::cout << "    CPU Time:    " << partialcol_result.elapsed_ms << " ms" << std::endl;
+            log_file << "    CPU Time:    " << partialcol_result.elapsed_ms << " ms" << std::endl;
+            std::string partialcol_report =
+                formatPartialColReport(partialcol_result, partialcol_colors, partialcol_options.initial_algorithm);
+            std::cout << partialcol_report << std::endl;
+            log_file << partialcol_report << std::endl;
+            if (partialcol_result.success && !coloring_output_folder.empty()) {
+                std::string base_name = full_path_filename.substr(full_path_filename.find_last_of('/') + 1);
+                writeColoringFile(coloring_output_folder + base_name + ".PartialCol.sol", partialcol_result.coloring, original_ids);
+            }
+        }
     }
 
     // Final message to log file and console
@@ -656,7 +1562,13 @@ int main() {
     log_file << "--- Graph Coloring Algorithms Comparison Session End: " << std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()) << " ---" << std::endl;
     std::cout << "\n--- All specified files processed ---" << std::endl;
 
+#ifdef GC_TRACE
+    if (!trace_json_filename.empty()) {
+        PhaseTracer::writeChromeTrace(trace_json_filename);
+    }
+#endif
+
     log_file.close();
 
     return 0;
-}
\ No newline at end of file
+}
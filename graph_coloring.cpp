@@ -0,0 +1,4570 @@
+#include "graph_coloring.h"
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <algorithm> // For std::sort, std::max, std::fill
+#include <chrono>    // For high-resolution timing
+#include <set>       // For calculating saturation degree (unique colors for DSATUR)
+#include <numeric>   // For std::iota (initial vertex orderings)
+#include <cstdlib>   // For std::abs
+#include <cstring>   // For std::strlen
+#include <cerrno>    // For errno when reading from decompressor processes
+#include <cmath>     // For std::log in the random graph generators
+#include <atomic>    // For the parallel degree counters
+#include <thread>    // For the parallel loader
+#include <memory>    // For std::unique_ptr
+#include <mutex>     // For the decompression pipeline
+#include <condition_variable>
+#include <deque>
+#include <cstdio>    // For FILE based decoders
+#include <limits>    // For the ID range of edge list files
+#include <cstdint>   // For the packed color masks
+#include <filesystem> // For the modification times checked by the graph cache
+#include <type_traits> // For std::decay_t in the dispatch on the neighbor ID width
+#include <iomanip>   // For the full precision generator cache keys
+
+#ifdef __linux__
+#include <unistd.h>
+#include <fcntl.h>    // Memory mapped loading
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h> // External decompressor processes
+#include <sys/syscall.h> // Thread IDs of the trace events
+#endif
+
+// Optional in-process decoders for compressed instances; without them the
+// command line tools (gzip, zstd, xz) are used
+#ifdef GC_WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef GC_WITH_ZSTD
+#include <zstd.h>
+#endif
+#ifdef GC_WITH_LZMA
+#include <lzma.h>
+#endif
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h> // First free color search (build with -march=native or GC_NATIVE)
+#endif
+
+// Copies the neighbor lists into ids, row after row, freeing each list once copied
+template <typename Id>
+static void packNeighborIds(std::vector<Vertex>& vertices, const std::vector<size_t>& offsets, std::vector<Id>& ids) {
+    ids.resize(offsets.back());
+    for (size_t v = 1; v < vertices.size(); ++v) {
+        std::copy(vertices[v].neighbors.begin(), vertices[v].neighbors.end(), ids.begin() + offsets[v]);
+        std::vector<int>().swap(vertices[v].neighbors);
+    }
+}
+
+Graph::Graph(std::vector<Vertex> vertices, int num_edges)
+    : num_vertices_(vertices.empty() ? 0 : static_cast<int>(vertices.size()) - 1), num_edges_(num_edges) {
+    offsets_.assign(num_vertices_ + 2, 0);
+    for (int v = 1; v <= num_vertices_; ++v) {
+        offsets_[v + 1] = offsets_[v] + vertices[v].neighbors.size();
+    }
+    wide_ids_ = num_vertices_ > std::numeric_limits<uint16_t>::max();
+    if (wide_ids_) {
+        packNeighborIds(vertices, offsets_, wide_);
+    } else {
+        packNeighborIds(vertices, offsets_, narrow_);
+    }
+}
+
+std::vector<Vertex> Graph::release() {
+    std::vector<Vertex> vertices(num_vertices_ + 1);
+    visit([&vertices](const auto& view) {
+        for (int v = 1; v <= view.numVertices(); ++v) {
+            auto neighbors = view.neighbors(v);
+            vertices[v].id = v;
+            vertices[v].degree = static_cast<int>(neighbors.size());
+            vertices[v].neighbors.assign(neighbors.begin(), neighbors.end());
+        }
+    });
+    *this = Graph();
+    return vertices;
+}
+
+// Appends value as a LEB128 varint (see decodeVarint)
+static void appendVarint(std::vector<uint8_t>& bytes, uint32_t value) {
+    while (value >= 0x80) {
+        bytes.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(value));
+}
+
+// Appends the values of one row in the layout PackedNeighborIterator reads: a 2-bit
+// length code per value, four to a byte, then every value in that many bytes
+static void appendPackedValues(std::vector<uint8_t>& bytes, const std::vector<uint32_t>& values) {
+    size_t controls = bytes.size();
+    bytes.resize(controls + (values.size() + 3) / 4, 0);
+    for (size_t i = 0; i < values.size(); ++i) {
+        uint32_t value = values[i];
+        int length = value < (1u << 8) ? 1 : value < (1u << 16) ? 2 : value < (1u << 24) ? 3 : 4;
+        bytes[controls + i / 4] |= static_cast<uint8_t>((length - 1) << ((i % 4) * 2));
+        for (int b = 0; b < length; ++b) {
+            bytes.push_back(static_cast<uint8_t>(value >> (8 * b)));
+        }
+    }
+}
+
+bool Graph::compressAdjacency() {
+    if (compressed_) {
+        return true;
+    }
+    std::vector<uint8_t> packed;
+    std::vector<uint64_t> block_offsets;
+    std::vector<uint32_t> row_offsets(num_vertices_ + 1);
+    std::vector<uint32_t> values; // Of the current row
+    bool fits = visit([&](const auto& view) {
+        // Rows are appended in vertex order, vertex 0 included as an empty row
+        for (int v = 0; v <= num_vertices_; ++v) {
+            if ((v & ((1 << CompressedGraphView::kBlockShift) - 1)) == 0) {
+                block_offsets.push_back(packed.size());
+            }
+            uint64_t offset = packed.size() - block_offsets.back();
+            if (offset > std::numeric_limits<uint32_t>::max()) {
+                return false;
+            }
+            row_offsets[v] = static_cast<uint32_t>(offset);
+            values.clear();
+            int previous = v;
+            if (v > 0) {
+                for (int neighbor_id : view.neighbors(v)) { // Sorted, so every later gap is positive
+                    if (values.empty()) {
+                        int delta = neighbor_id - v;
+                        values.push_back((static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31));
+                    } else {
+                        values.push_back(static_cast<uint32_t>(neighbor_id - previous - 1));
+                    }
+                    previous = neighbor_id;
+                }
+            }
+            appendVarint(packed, static_cast<uint32_t>(values.size()));
+            appendPackedValues(packed, values);
+        }
+        return true;
+    });
+    if (!fits) {
+        std::cerr << "Error: A block of rows is too large for the compressed adjacency" << std::endl;
+        return false;
+    }
+    packed.resize(packed.size() + 16, 0); // The iterators decode a group of four ahead, 16 bytes at a time
+    packed.shrink_to_fit();
+    packed_.swap(packed);
+    block_offsets_.swap(block_offsets);
+    row_offsets_.swap(row_offsets);
+    std::vector<size_t>().swap(offsets_);
+    std::vector<uint16_t>().swap(narrow_);
+    std::vector<uint32_t>().swap(wide_);
+    compressed_ = true;
+    return true;
+}
+
+
+// Parses a decimal integer in [cursor, end) after optional blanks. Values beyond the
+// range of long saturate, as with strtol. Returns false if there are no digits.
+static bool parseBoundedInt(const char*& cursor, const char* end, long& value) {
+    while (cursor < end && (*cursor == ' ' || *cursor == '\t')) {
+        cursor++;
+    }
+    bool negative = cursor < end && *cursor == '-';
+    if (negative) {
+        cursor++;
+    }
+    const char* digits = cursor;
+    value = 0;
+    while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+        int digit = *cursor - '0';
+        value = value > (std::numeric_limits<long>::max() - digit) / 10 ? std::numeric_limits<long>::max()
+                                                                          : value * 10 + digit;
+        cursor++;
+    }
+    if (negative) {
+        value = -value;
+    }
+    return cursor != digits;
+}
+
+// Streams the lines of a DIMACS file once: validates the 'p' and 'e' lines, calls
+// on_problem() after the 'p' line has set num_vertices and num_edges, and
+// on_edge(u, v) for every edge line. The endpoints are passed as long, as read, so
+// that the caller's range check also catches values that do not fit in an int.
+// Returns false on malformed input.
+template <typename OnProblem, typename OnEdge>
+static bool scanDimacsLines(std::istream& file, const std::string& filename, int& num_vertices, int& num_edges,
+                     OnProblem on_problem, OnEdge on_edge) {
+    std::string line;
+    bool problem_line_found = false;
+
+    while (std::getline(file, line)) {
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos) { // Skip empty lines
+            continue;
+        }
+        char type = line[first];
+
+        if (type == 'c') {
+            // Comment line, ignore
+            continue;
+        } else if (type == 'p') {
+            if (problem_line_found) {
+                std::cerr << "Error: More than one 'p' line in '" << filename << "'" << std::endl;
+                return false;
+            }
+            std::istringstream iss(line.substr(first + 1));
+            std::string problem_type;
+            if (!(iss >> problem_type >> num_vertices >> num_edges) || num_vertices < 0 || num_edges < 0) {
+                std::cerr << "Error: Malformed 'p' line in '" << filename << "'" << std::endl;
+                return false;
+            }
+            // Allow "edge" and "col" problem types for graph coloring benchmarks
+            if (problem_type != "edge" && problem_type != "col") {
+                std::cerr << "Error: Unsupported problem type '" << problem_type << "' in '" << filename << "'. Only 'edge' or 'col' types are supported by this parser." << std::endl;
+                return false;
+            }
+            problem_line_found = true;
+            on_problem();
+        } else if (type == 'e') {
+            if (!problem_line_found) {
+                std::cerr << "Error: 'e' line found before 'p' line in '" << filename << "'" << std::endl;
+                return false;
+            }
+            // Edge lines are the bulk of the file, so they are parsed without a stream
+            const char* cursor = line.c_str() + first + 1;
+            char* end_u;
+            char* end_v;
+            long u = std::strtol(cursor, &end_u, 10);
+            long v = std::strtol(end_u, &end_v, 10);
+            if (end_u == cursor || end_v == end_u) {
+                std::cerr << "Error: Malformed 'e' line in '" << filename << "'" << std::endl;
+                return false;
+            }
+            on_edge(u, v);
+        }
+    }
+
+    if (!problem_line_found) {
+        std::cerr << "Error: No 'p' line found in '" << filename << "'" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Runs fn(thread_index) on num_threads threads (the calling thread being index 0) and waits for all.
+template <typename Function>
+static void runOnThreads(int num_threads, Function fn) {
+    std::vector<std::thread> threads;
+    for (int t = 1; t < num_threads; ++t) {
+        threads.emplace_back(fn, t);
+    }
+    fn(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+// num_threads - 1 threads started once, that run fn(thread_index) together with the calling
+// thread (index 0) on every call of run. For loops of short rounds, where starting threads
+// for each round as runOnThreads does would cost more than the work; thread t is the same
+// thread in every round, so state kept per index stays on one thread.
+class ThreadTeam {
+public:
+    explicit ThreadTeam(int num_threads) {
+        for (int t = 1; t < num_threads; ++t) {
+            threads_.emplace_back(&ThreadTeam::work, this, t);
+        }
+    }
+    ~ThreadTeam() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        changed_.notify_all();
+        for (std::thread& thread : threads_) {
+            thread.join();
+        }
+    }
+    ThreadTeam(const ThreadTeam&) = delete;
+    ThreadTeam& operator=(const ThreadTeam&) = delete;
+
+    // Runs fn(thread_index) on every thread of the team and waits for all
+    void run(const std::function<void(int)>& fn) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            task_ = &fn;
+            round_++;
+            busy_ = static_cast<int>(threads_.size());
+        }
+        changed_.notify_all();
+        fn(0);
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [this]() { return busy_ == 0; });
+    }
+
+private:
+    void work(int thread_index) {
+        long long done_round = 0;
+        while (true) {
+            const std::function<void(int)>* task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                changed_.wait(lock, [&]() { return stopping_ || round_ != done_round; });
+                if (stopping_) {
+                    return;
+                }
+                done_round = round_;
+                task = task_;
+            }
+            (*task)(thread_index);
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--busy_ == 0) {
+                changed_.notify_all();
+            }
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable changed_; // A new round, the end of a round or stopping
+    const std::function<void(int)>* task_ = nullptr;
+    long long round_ = 0;
+    int busy_ = 0; // Threads still running the current round
+    bool stopping_ = false;
+    std::vector<std::thread> threads_; // Declared last: start after the members they use
+};
+
+// Builds the adjacency rows of a graph with n vertices from buffers of edges (u, v), u != v,
+// both in 1..n. Degrees are counted with atomic increments, every row is allocated with its
+// exact size and filled through atomic per-row cursors (one thread per buffer), then rows
+// are sorted and made unique on num_threads threads. The buffers are released as they are
+// consumed; duplicate_edges and simple_edges of stats are filled in.
+static void buildRowsFromEdgeBuffers(std::vector<std::vector<std::pair<int, int>>>& edge_buffers, int n,
+                              std::vector<Vertex>& vertices, GraphLoadStats& stats, int num_threads) {
+    const int num_buffers = static_cast<int>(edge_buffers.size());
+    num_threads = std::max(1, num_threads);
+
+    // Count the degrees, then allocate every row with its exact size
+    std::unique_ptr<std::atomic<int>[]> slot_cursor(new std::atomic<int>[n + 1]);
+    for (int i = 0; i <= n; ++i) {
+        slot_cursor[i].store(0, std::memory_order_relaxed);
+    }
+    runOnThreads(num_buffers, [&](int t) {
+        for (const auto& edge : edge_buffers[t]) {
+            slot_cursor[edge.first].fetch_add(1, std::memory_order_relaxed);
+            slot_cursor[edge.second].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    vertices.resize(n + 1);
+    auto vertex_range = [n, num_threads](int t) {
+        return std::make_pair(1 + static_cast<int>(static_cast<long long>(n) * t / num_threads),
+                              1 + static_cast<int>(static_cast<long long>(n) * (t + 1) / num_threads));
+    };
+    runOnThreads(num_threads, [&](int t) {
+        auto range = vertex_range(t);
+        for (int i = range.first; i < range.second; ++i) {
+            vertices[i].id = i;
+            vertices[i].neighbors.resize(slot_cursor[i].load(std::memory_order_relaxed));
+        }
+    });
+
+    // Fill the rows: slot_cursor counts down to the next free slot of every row
+    runOnThreads(num_buffers, [&](int t) {
+        for (const auto& edge : edge_buffers[t]) {
+            vertices[edge.first].neighbors[slot_cursor[edge.first].fetch_sub(1, std::memory_order_relaxed) - 1] = edge.second;
+            vertices[edge.second].neighbors[slot_cursor[edge.second].fetch_sub(1, std::memory_order_relaxed) - 1] = edge.first;
+        }
+        std::vector<std::pair<int, int>>().swap(edge_buffers[t]); // Release the buffer early
+    });
+
+    // Sort and unique every row to drop duplicated edges
+    std::vector<long long> removed_entries(num_threads, 0);
+    std::vector<long long> kept_entries(num_threads, 0);
+    runOnThreads(num_threads, [&](int t) {
+        auto range = vertex_range(t);
+        for (int i = range.first; i < range.second; ++i) {
+            std::vector<int>& neighbors = vertices[i].neighbors;
+            std::sort(neighbors.begin(), neighbors.end());
+            size_t unique_size = std::unique(neighbors.begin(), neighbors.end()) - neighbors.begin();
+            removed_entries[t] += neighbors.size() - unique_size;
+            neighbors.resize(unique_size);
+            vertices[i].degree = static_cast<int>(unique_size);
+            kept_entries[t] += unique_size;
+        }
+    });
+    stats.duplicate_edges = std::accumulate(removed_entries.begin(), removed_entries.end(), 0LL) / 2;
+    stats.simple_edges = std::accumulate(kept_entries.begin(), kept_entries.end(), 0LL) / 2;
+}
+
+// Compression formats readGraphFile accepts, recognized by their magic bytes
+enum class Compression { None, Gzip, Zstd, Xz };
+
+static Compression detectCompression(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    unsigned char magic[6] = {0, 0, 0, 0, 0, 0};
+    file.read(reinterpret_cast<char*>(magic), sizeof(magic));
+    if (magic[0] == 0x1F && magic[1] == 0x8B) {
+        return Compression::Gzip;
+    }
+    if (magic[0] == 0x28 && magic[1] == 0xB5 && magic[2] == 0x2F && magic[3] == 0xFD) {
+        return Compression::Zstd;
+    }
+    if (magic[0] == 0xFD && magic[1] == '7' && magic[2] == 'z' && magic[3] == 'X' && magic[4] == 'Z' && magic[5] == 0x00) {
+        return Compression::Xz;
+    }
+    return Compression::None;
+}
+
+// A stream of decompressed bytes
+class DecompressedSource {
+public:
+    virtual ~DecompressedSource() = default;
+    // Fills up to capacity bytes; returns the number of bytes, 0 at the end, -1 on error
+    virtual long read(char* buffer, size_t capacity) = 0;
+};
+
+#ifdef GC_WITH_ZLIB
+// gzip decoding with zlib (build with -DGC_WITH_ZLIB -lz); handles concatenated members
+class GzipSource : public DecompressedSource {
+public:
+    explicit GzipSource(const std::string& filename) : file_(std::fopen(filename.c_str(), "rb")), input_(1 << 16) {
+        std::memset(&stream_, 0, sizeof(stream_));
+        ok_ = file_ != nullptr && inflateInit2(&stream_, 15 + 32) == Z_OK; // 32: detect the gzip header
+    }
+    ~GzipSource() override {
+        inflateEnd(&stream_);
+        if (file_ != nullptr) {
+            std::fclose(file_);
+        }
+    }
+    long read(char* buffer, size_t capacity) override {
+        if (!ok_) {
+            return -1;
+        }
+        stream_.next_out = reinterpret_cast<Bytef*>(buffer);
+        stream_.avail_out = static_cast<uInt>(capacity);
+        while (stream_.avail_out == capacity) {
+            if (stream_.avail_in == 0) {
+                stream_.avail_in = static_cast<uInt>(std::fread(input_.data(), 1, input_.size(), file_));
+                stream_.next_in = reinterpret_cast<Bytef*>(input_.data());
+                if (stream_.avail_in == 0) {
+                    return std::ferror(file_) || !finished_member_ ? -1 : 0;
+                }
+            }
+            finished_member_ = false;
+            int status = inflate(&stream_, Z_NO_FLUSH);
+            if (status == Z_STREAM_END) {
+                finished_member_ = true;
+                inflateReset(&stream_);
+            } else if (status != Z_OK && status != Z_BUF_ERROR) {
+                return -1;
+            }
+        }
+        return static_cast<long>(capacity - stream_.avail_out);
+    }
+
+private:
+    FILE* file_;
+    std::vector<char> input_;
+    z_stream stream_;
+    bool ok_ = false;
+    bool finished_member_ = false;
+};
+#endif
+
+#ifdef GC_WITH_ZSTD
+// zstd decoding with libzstd (build with -DGC_WITH_ZSTD -lzstd)
+class ZstdSource : public DecompressedSource {
+public:
+    explicit ZstdSource(const std::string& filename)
+        : file_(std::fopen(filename.c_str(), "rb")), stream_(ZSTD_createDStream()), input_(ZSTD_DStreamInSize()) {
+        ok_ = file_ != nullptr && stream_ != nullptr && !ZSTD_isError(ZSTD_initDStream(stream_));
+    }
+    ~ZstdSource() override {
+        ZSTD_freeDStream(stream_);
+        if (file_ != nullptr) {
+            std::fclose(file_);
+        }
+    }
+    long read(char* buffer, size_t capacity) override {
+        if (!ok_) {
+            return -1;
+        }
+        ZSTD_outBuffer out = {buffer, capacity, 0};
+        while (out.pos == 0) {
+            if (in_.pos == in_.size) {
+                in_.size = std::fread(input_.data(), 1, input_.size(), file_);
+                in_.src = input_.data();
+                in_.pos = 0;
+                if (in_.size == 0) {
+                    return std::ferror(file_) || last_result_ != 0 ? -1 : 0;
+                }
+            }
+            last_result_ = ZSTD_decompressStream(stream_, &out, &in_);
+            if (ZSTD_isError(last_result_)) {
+                return -1;
+            }
+        }
+        return static_cast<long>(out.pos);
+    }
+
+private:
+    FILE* file_;
+    ZSTD_DStream* stream_;
+    std::vector<char> input_;
+    ZSTD_inBuffer in_ = {nullptr, 0, 0};
+    size_t last_result_ = 0;
+    bool ok_ = false;
+};
+#endif
+
+#ifdef GC_WITH_LZMA
+// xz decoding with liblzma (build with -DGC_WITH_LZMA -llzma)
+class XzSource : public DecompressedSource {
+public:
+    explicit XzSource(const std::string& filename) : file_(std::fopen(filename.c_str(), "rb")), input_(1 << 16) {
+        ok_ = file_ != nullptr && lzma_stream_decoder(&stream_, UINT64_MAX, LZMA_CONCATENATED) == LZMA_OK;
+    }
+    ~XzSource() override {
+        lzma_end(&stream_);
+        if (file_ != nullptr) {
+            std::fclose(file_);
+        }
+    }
+    long read(char* buffer, size_t capacity) override {
+        if (!ok_) {
+            return -1;
+        }
+        stream_.next_out = reinterpret_cast<uint8_t*>(buffer);
+        stream_.avail_out = capacity;
+        while (stream_.avail_out == capacity && !finished_) {
+            lzma_action action = LZMA_RUN;
+            if (stream_.avail_in == 0) {
+                stream_.avail_in = std::fread(input_.data(), 1, input_.size(), file_);
+                stream_.next_in = reinterpret_cast<const uint8_t*>(input_.data());
+                if (std::ferror(file_)) {
+                    return -1;
+                }
+                if (stream_.avail_in == 0) {
+                    action = LZMA_FINISH;
+                }
+            }
+            lzma_ret status = lzma_code(&stream_, action);
+            if (status == LZMA_STREAM_END) {
+                finished_ = true;
+            } else if (status != LZMA_OK) {
+                return -1;
+            }
+        }
+        return static_cast<long>(capacity - stream_.avail_out);
+    }
+
+private:
+    FILE* file_;
+    std::vector<char> input_;
+    lzma_stream stream_ = LZMA_STREAM_INIT;
+    bool ok_ = false;
+    bool finished_ = false;
+};
+#endif
+
+#ifdef __linux__
+// Fallback when the library of a format is not compiled in: runs the command line
+// decompressor ("gzip -dc", "zstd -dc", "xz -dc") as a child process and reads its output.
+class ChildProcessSource : public DecompressedSource {
+public:
+    ChildProcessSource(const char* tool, const std::string& filename) {
+        // Close-on-exec, so that decompressors started meanwhile by other threads (parallel
+        // loads, the --serve workers) do not inherit the write end and delay our EOF; dup2
+        // gives the child a stdout without the flag
+        int fds[2];
+        if (pipe2(fds, O_CLOEXEC) != 0) {
+            return;
+        }
+        pid_ = fork();
+        if (pid_ == 0) {
+            dup2(fds[1], STDOUT_FILENO);
+            close(fds[0]);
+            close(fds[1]);
+            execlp(tool, tool, "-dc", "--", filename.c_str(), static_cast<char*>(nullptr));
+            _exit(127);
+        }
+        close(fds[1]);
+        fd_ = pid_ > 0 ? fds[0] : -1;
+        if (fd_ < 0) {
+            close(fds[0]);
+        }
+    }
+    ~ChildProcessSource() override {
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+        if (pid_ > 0) {
+            waitpid(pid_, nullptr, 0);
+        }
+    }
+    long read(char* buffer, size_t capacity) override {
+        if (fd_ < 0) {
+            return -1;
+        }
+        ssize_t bytes;
+        do {
+            bytes = ::read(fd_, buffer, capacity);
+        } while (bytes < 0 && errno == EINTR);
+        if (bytes == 0) {
+            // End of output: the data is only complete if the decompressor succeeded
+            close(fd_);
+            fd_ = -1;
+            int status = 0;
+            waitpid(pid_, &status, 0);
+            pid_ = -1;
+            return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? 0 : -1;
+        }
+        return bytes < 0 ? -1 : static_cast<long>(bytes);
+    }
+
+private:
+    int fd_ = -1;
+    pid_t pid_ = -1;
+};
+#endif
+
+// Opens the best available decoder for a compressed file, or returns nullptr
+static std::unique_ptr<DecompressedSource> openDecompressedSource(const std::string& filename, Compression compression) {
+    switch (compression) {
+        case Compression::Gzip:
+#ifdef GC_WITH_ZLIB
+            return std::unique_ptr<DecompressedSource>(new GzipSource(filename));
+#elif defined(__linux__)
+            return std::unique_ptr<DecompressedSource>(new ChildProcessSource("gzip", filename));
+#endif
+            break;
+        case Compression::Zstd:
+#ifdef GC_WITH_ZSTD
+            return std::unique_ptr<DecompressedSource>(new ZstdSource(filename));
+#elif defined(__linux__)
+            return std::unique_ptr<DecompressedSource>(new ChildProcessSource("zstd", filename));
+#endif
+            break;
+        case Compression::Xz:
+#ifdef GC_WITH_LZMA
+            return std::unique_ptr<DecompressedSource>(new XzSource(filename));
+#elif defined(__linux__)
+            return std::unique_ptr<DecompressedSource>(new ChildProcessSource("xz", filename));
+#endif
+            break;
+        default:
+            break;
+    }
+    return nullptr;
+}
+
+// Stream buffer that decompresses on a second thread. The decoder thread fills blocks
+// into a small bounded queue while the parser consumes the previous ones through the
+// usual std::istream interface, so decompression overlaps with parsing.
+class DecompressingStreamBuffer : public std::streambuf {
+public:
+    static const size_t kBlockSize = 1 << 20;
+    static const size_t kQueuedBlocks = 4;
+
+    explicit DecompressingStreamBuffer(std::unique_ptr<DecompressedSource> source)
+        : source_(std::move(source)), decoder_([this]() { decode(); }) {}
+
+    ~DecompressingStreamBuffer() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        changed_.notify_all();
+        decoder_.join();
+    }
+
+    // True if the decoder reported corrupt or truncated input
+    bool failed() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return failed_;
+    }
+
+protected:
+    int_type underflow() override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!current_.empty()) {
+            free_blocks_.push_back(std::move(current_)); // Hand the consumed block back
+            current_.clear();
+            changed_.notify_all();
+        }
+        changed_.wait(lock, [this]() { return !filled_blocks_.empty() || finished_; });
+        if (filled_blocks_.empty()) {
+            return traits_type::eof();
+        }
+        current_ = std::move(filled_blocks_.front());
+        filled_blocks_.pop_front();
+        changed_.notify_all();
+        setg(current_.data(), current_.data(), current_.data() + current_.size());
+        return traits_type::to_int_type(current_[0]);
+    }
+
+private:
+    void decode() {
+        while (true) {
+            std::vector<char> block;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                changed_.wait(lock, [this]() { return stopping_ || filled_blocks_.size() < kQueuedBlocks; });
+                if (stopping_) {
+                    break;
+                }
+                if (!free_blocks_.empty()) {
+                    block = std::move(free_blocks_.back());
+                    free_blocks_.pop_back();
+                }
+            }
+            block.resize(kBlockSize);
+            long bytes = source_->read(block.data(), block.size());
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (bytes <= 0) {
+                failed_ = bytes < 0;
+                break;
+            }
+            block.resize(bytes);
+            filled_blocks_.push_back(std::move(block));
+            changed_.notify_all();
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        finished_ = true;
+        changed_.notify_all();
+    }
+
+    std::unique_ptr<DecompressedSource> source_;
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    std::deque<std::vector<char>> filled_blocks_;
+    std::vector<std::vector<char>> free_blocks_;
+    std::vector<char> current_; // Block being parsed
+    bool stopping_ = false;
+    bool finished_ = false;
+    bool failed_ = false;
+    std::thread decoder_; // Declared last: starts after the members it uses
+};
+
+bool parseGraphFormat(const std::string& name, GraphFormat& format) {
+    if (name == "auto") {
+        format = GraphFormat::Auto;
+    } else if (name == "dimacs") {
+        format = GraphFormat::Dimacs;
+    } else if (name == "dimacs-binary") {
+        format = GraphFormat::DimacsBinary;
+    } else if (name == "metis") {
+        format = GraphFormat::Metis;
+    } else if (name == "edgelist") {
+        format = GraphFormat::EdgeList;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string graphFormatName(GraphFormat format) {
+    switch (format) {
+        case GraphFormat::Dimacs: return "DIMACS";
+        case GraphFormat::DimacsBinary: return "DIMACS binary";
+        case GraphFormat::Metis: return "METIS";
+        case GraphFormat::EdgeList: return "edge list";
+        default: return "auto";
+    }
+}
+
+// Reads up to size bytes from the start of a file, decompressed if needed
+static std::string readFileHead(const std::string& filename, Compression compression, size_t size) {
+    std::string head(size, '\0');
+    size_t filled = 0;
+    if (compression == Compression::None) {
+        std::ifstream file(filename, std::ios::binary);
+        file.read(&head[0], size);
+        filled = static_cast<size_t>(file.gcount());
+    } else {
+        std::unique_ptr<DecompressedSource> source = openDecompressedSource(filename, compression);
+        while (source != nullptr && filled < size) {
+            long bytes = source->read(&head[filled], size - filled);
+            if (bytes <= 0) {
+                break;
+            }
+            filled += bytes;
+        }
+    }
+    head.resize(filled);
+    return head;
+}
+
+// True if only blanks are left in [cursor, end)
+static bool atLineEnd(const char* cursor, const char* end) {
+    while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r')) {
+        cursor++;
+    }
+    return cursor == end;
+}
+
+// True if head (the whole file if complete) reads as METIS: a header "n m [fmt [ncon]]"
+// with a valid format code, then at most n vertex lines (exactly n if complete), whose
+// neighbors all lie in 1..n when the format has no weights. An edge list only passes if
+// its first edge happens to fit all of this for the lines that follow.
+static bool looksLikeMetis(const std::string& head, bool complete) {
+    std::istringstream lines(complete ? head : head.substr(0, head.rfind('\n') + 1));
+    std::string line;
+    bool have_header = false;
+    long n = 0;
+    bool unweighted = true;
+    long vertex_lines = 0;
+    while (std::getline(lines, line)) {
+        if (!line.empty() && line[0] == '%') {
+            continue;
+        }
+        const char* cursor = line.c_str();
+        const char* end = cursor + line.size();
+        if (!have_header) {
+            long m;
+            if (!parseBoundedInt(cursor, end, n) || !parseBoundedInt(cursor, end, m) || n <= 0 || m < 0) {
+                return false;
+            }
+            std::istringstream rest(std::string(cursor, end));
+            std::string format_code = "0";
+            long num_constraints = 1;
+            rest >> format_code >> num_constraints;
+            if (format_code.size() > 3 || format_code.find_first_not_of("01") != std::string::npos ||
+                num_constraints < 0 || rest >> format_code) {
+                return false;
+            }
+            unweighted = format_code.find('1') == std::string::npos;
+            have_header = true;
+            continue;
+        }
+        if (vertex_lines == n && atLineEnd(cursor, end)) {
+            continue; // Blank lines after the last vertex
+        }
+        if (++vertex_lines > n) {
+            return false;
+        }
+        long v;
+        while (unweighted && parseBoundedInt(cursor, end, v)) {
+            if (v <= 0 || v > n) {
+                return false;
+            }
+        }
+        if (unweighted && !atLineEnd(cursor, end)) {
+            return false;
+        }
+    }
+    return have_header && (!complete || vertex_lines == n);
+}
+
+// Guesses the format from the first bytes of a file (all of it if complete):
+//   a first line with only a number, followed by 'c' or 'p' text -> DIMACS binary
+//   'c', 'p' or 'e' as the first character                       -> DIMACS
+//   a METIS header consistent with the lines after it            -> METIS
+//   a header followed by lines with a different number of fields -> METIS
+//   anything else                                                -> edge list
+static GraphFormat sniffGraphFormat(const std::string& head, bool complete) {
+    size_t first = head.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) {
+        return GraphFormat::Dimacs;
+    }
+    if (head[first] == 'c' || head[first] == 'p' || head[first] == 'e') {
+        return GraphFormat::Dimacs;
+    }
+    size_t first_line_end = head.find('\n');
+    if (first_line_end != std::string::npos && first_line_end + 1 < head.size() &&
+        head.find_first_not_of("0123456789 \t\r") >= first_line_end &&
+        (head[first_line_end + 1] == 'c' || head[first_line_end + 1] == 'p')) {
+        return GraphFormat::DimacsBinary;
+    }
+    if (looksLikeMetis(head, complete)) {
+        return GraphFormat::Metis;
+    }
+
+    // Compare the field counts of the complete lines in the head
+    std::istringstream lines(head.substr(0, head.rfind('\n') + 1));
+    std::string line;
+    int header_fields = -1;
+    while (std::getline(lines, line)) {
+        if (!line.empty() && (line[0] == '%' || line[0] == '#')) {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string field;
+        int num_fields = 0;
+        while (fields >> field) {
+            num_fields++;
+        }
+        if (header_fields < 0) {
+            header_fields = num_fields;
+        } else if (num_fields != header_fields) {
+            return GraphFormat::Metis;
+        }
+    }
+    return GraphFormat::EdgeList;
+}
+
+// Picks the format of a graph file from its extension (a compression suffix such as
+// .gz is looked through) and sniffs the content when the extension is not known.
+static GraphFormat detectGraphFormat(const std::string& filename, Compression compression) {
+    std::string name = filename;
+    auto has_suffix = [&name](const std::string& suffix) {
+        return name.size() >= suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+    };
+    for (const char* suffix : {".gz", ".zst", ".xz"}) {
+        if (has_suffix(suffix)) {
+            name.resize(name.size() - std::strlen(suffix));
+            break;
+        }
+    }
+    if (has_suffix(".b")) {
+        return GraphFormat::DimacsBinary;
+    }
+    if (has_suffix(".col") || has_suffix(".clq") || has_suffix(".dimacs")) {
+        return GraphFormat::Dimacs;
+    }
+    if (has_suffix(".graph") || has_suffix(".metis")) {
+        return GraphFormat::Metis;
+    }
+    if (has_suffix(".el") || has_suffix(".edges") || has_suffix(".edgelist")) {
+        return GraphFormat::EdgeList;
+    }
+    const size_t head_size = 4096;
+    std::string head = readFileHead(filename, compression, head_size);
+    return sniffGraphFormat(head, head.size() < head_size);
+}
+
+// Reads DIMACS text that can only be streamed once (e.g. decompressed on the fly):
+// the edges are parsed into a buffer and the rows are then built from it, with the
+// same result and stats as the two-pass plain text path.
+static bool readDimacsStream(std::istream& file, const std::string& filename, std::vector<Vertex>& vertices,
+                      int& num_vertices, int& num_edges, GraphLoadStats& stats) {
+    std::vector<std::vector<std::pair<int, int>>> edge_buffers(1);
+    std::vector<std::pair<int, int>>& edges = edge_buffers[0];
+
+    bool parsed = scanDimacsLines(file, filename, num_vertices, num_edges,
+        [&]() {
+            if (num_edges > 0) {
+                edges.reserve(num_edges);
+            }
+        },
+        [&](long u, long v) {
+            stats.edge_lines++;
+            if (u <= 0 || u > num_vertices || v <= 0 || v > num_vertices) {
+                std::cerr << "Warning: Invalid vertex ID (" << u << ", " << v << ") in edge in '" << filename << "'. Max vertex ID is " << num_vertices << std::endl;
+                stats.invalid_edges++;
+            } else if (u == v) {
+                stats.self_loops++;
+            } else {
+                edges.push_back({static_cast<int>(u), static_cast<int>(v)});
+            }
+        });
+    if (!parsed) {
+        return false;
+    }
+
+    buildRowsFromEdgeBuffers(edge_buffers, num_vertices, vertices, stats, 1);
+    return true;
+}
+
+// Reads the DIMACS binary format (.col.b): a line with the length of the preamble, the
+// preamble text holding the 'p' line, then the lower triangle of the adjacency matrix,
+// row i (0-based) packed in (i + 8) / 8 bytes with column j at bit 7 - j % 8 of byte j / 8.
+// The rows are built straight from the matrix bits without an intermediate edge list:
+// one sweep counts the degrees, a second one fills the exact-sized rows. Row i only
+// holds columns j <= i and rows are swept in order, so every row comes out sorted.
+static bool readDimacsBinaryStream(std::istream& file, const std::string& filename, std::vector<Vertex>& vertices,
+                            int& num_vertices, int& num_edges, GraphLoadStats& stats) {
+    std::string length_line;
+    long preamble_length = 0;
+    const char* cursor = length_line.c_str();
+    if (std::getline(file, length_line)) {
+        cursor = length_line.c_str();
+    }
+    if (!parseBoundedInt(cursor, length_line.c_str() + length_line.size(), preamble_length) ||
+        preamble_length <= 0 || !atLineEnd(cursor, length_line.c_str() + length_line.size())) {
+        std::cerr << "Error: Malformed preamble length in binary DIMACS file '" << filename << "'" << std::endl;
+        return false;
+    }
+    std::string preamble(preamble_length, '\0');
+    if (!file.read(&preamble[0], preamble_length)) {
+        std::cerr << "Error: Truncated preamble in binary DIMACS file '" << filename << "'" << std::endl;
+        return false;
+    }
+    std::istringstream preamble_lines(preamble);
+    if (!scanDimacsLines(preamble_lines, filename, num_vertices, num_edges, []() {}, [](long, long) {})) {
+        return false;
+    }
+
+    std::vector<size_t> row_offsets(num_vertices + 1, 0);
+    for (int i = 0; i < num_vertices; ++i) {
+        row_offsets[i + 1] = row_offsets[i] + (i + 8) / 8;
+    }
+    std::vector<unsigned char> matrix(row_offsets[num_vertices]);
+    if (!file.read(reinterpret_cast<char*>(matrix.data()), static_cast<std::streamsize>(matrix.size()))) {
+        std::cerr << "Error: Truncated adjacency matrix in binary DIMACS file '" << filename << "'" << std::endl;
+        return false;
+    }
+
+    // Calls on_bit(j) for the set columns j <= i of row i, in increasing order.
+    // Bits past the diagonal only pad the last byte of the row.
+    auto for_each_bit = [&](int i, auto on_bit) {
+        const unsigned char* row = matrix.data() + row_offsets[i];
+        for (int byte = 0; byte <= i / 8; ++byte) {
+            if (row[byte] == 0) {
+                continue;
+            }
+            int last_bit = std::min(7, i - byte * 8);
+            for (int bit = 0; bit <= last_bit; ++bit) {
+                if (row[byte] & (0x80 >> bit)) {
+                    on_bit(byte * 8 + bit);
+                }
+            }
+        }
+    };
+
+    std::vector<int> degrees(num_vertices, 0);
+    for (int i = 0; i < num_vertices; ++i) {
+        for_each_bit(i, [&](int j) {
+            stats.edge_lines++;
+            if (j == i) {
+                stats.self_loops++;
+            } else {
+                degrees[i]++;
+                degrees[j]++;
+                stats.simple_edges++;
+            }
+        });
+    }
+
+    vertices.resize(num_vertices + 1);
+    for (int i = 1; i <= num_vertices; ++i) {
+        vertices[i].id = i;
+        vertices[i].degree = degrees[i - 1];
+        vertices[i].neighbors.reserve(degrees[i - 1]);
+    }
+    for (int i = 0; i < num_vertices; ++i) {
+        for_each_bit(i, [&](int j) {
+            if (j != i) {
+                vertices[i + 1].neighbors.push_back(j + 1);
+                vertices[j + 1].neighbors.push_back(i + 1);
+            }
+        });
+    }
+    return true;
+}
+
+// Reads the METIS graph format: a header "n m [fmt [ncon]]", then one line per vertex
+// listing its neighbors (1-based). Depending on fmt a line starts with the vertex size
+// and ncon vertex weights, and each neighbor is followed by an edge weight; weights are
+// skipped. Lines starting with '%' are comments, empty lines are isolated vertices.
+// METIS lists every edge under both endpoints, so stats.edge_lines counts adjacency
+// entries and only entries beyond the expected two per edge count as duplicates.
+static bool readMetisStream(std::istream& file, const std::string& filename, std::vector<Vertex>& vertices,
+                     int& num_vertices, int& num_edges, GraphLoadStats& stats) {
+    std::string line;
+    auto next_line = [&]() {
+        while (std::getline(file, line)) {
+            if (line.empty() || line[0] != '%') {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    std::string format_code = "0";
+    int num_constraints = 1;
+    std::istringstream header(next_line() ? line : std::string());
+    if (!(header >> num_vertices >> num_edges) || num_vertices < 0) {
+        std::cerr << "Error: Malformed METIS header in '" << filename << "'" << std::endl;
+        return false;
+    }
+    header >> format_code >> num_constraints;
+    if (format_code.size() > 3 || format_code.find_first_not_of("01") != std::string::npos || num_constraints < 0) {
+        std::cerr << "Error: Unsupported METIS format code '" << format_code << "' in '" << filename << "'" << std::endl;
+        return false;
+    }
+    format_code.insert(0, 3 - format_code.size(), '0');
+    bool has_vertex_size = format_code[0] == '1';
+    int skipped_fields = (has_vertex_size ? 1 : 0) + (format_code[1] == '1' ? num_constraints : 0);
+    bool has_edge_weights = format_code[2] == '1';
+
+    std::vector<std::vector<std::pair<int, int>>> edge_buffers(1);
+    std::vector<std::pair<int, int>>& edges = edge_buffers[0];
+    if (num_edges > 0) {
+        edges.reserve(2 * static_cast<size_t>(num_edges));
+    }
+    for (int u = 1; u <= num_vertices; ++u) {
+        if (!next_line()) {
+            std::cerr << "Error: '" << filename << "' ends after " << u - 1 << " of " << num_vertices << " METIS vertex lines" << std::endl;
+            return false;
+        }
+        const char* cursor = line.c_str();
+        const char* end = cursor + line.size();
+        long value;
+        bool malformed = false;
+        for (int field = 0; field < skipped_fields && !malformed; ++field) {
+            malformed = !parseBoundedInt(cursor, end, value);
+        }
+        long v;
+        while (!malformed && parseBoundedInt(cursor, end, v)) {
+            if (has_edge_weights && !parseBoundedInt(cursor, end, value)) {
+                malformed = true;
+                break;
+            }
+            stats.edge_lines++;
+            if (v <= 0 || v > num_vertices) {
+                std::cerr << "Warning: Invalid vertex ID (" << u << ", " << v << ") in edge in '" << filename << "'. Max vertex ID is " << num_vertices << std::endl;
+                stats.invalid_edges++;
+            } else if (v == u) {
+                stats.self_loops++;
+            } else {
+                edges.push_back({std::min<int>(u, v), std::max<int>(u, v)});
+            }
+        }
+        if (malformed || !atLineEnd(cursor, end)) {
+            std::cerr << "Error: Malformed METIS line for vertex " << u << " in '" << filename << "'" << std::endl;
+            return false;
+        }
+    }
+
+    long long adjacency_entries = static_cast<long long>(edges.size());
+    buildRowsFromEdgeBuffers(edge_buffers, num_vertices, vertices, stats, 1);
+    stats.duplicate_edges = std::max(0LL, adjacency_entries - 2 * stats.simple_edges);
+    return true;
+}
+
+// Reads a plain edge list: one "u v" pair per line, optionally followed by a weight that
+// is ignored, with '#' and '%' comment lines. The vertex count is the largest ID; lists
+// using ID 0 are taken as 0-based and shifted to the 1-based IDs used here. IDs so sparse
+// that most of 1..largest would be unused (the largest exceeds twice the edge count) are
+// renumbered 1..k in increasing order instead, so a few huge IDs cannot allocate billions
+// of empty rows. num_edges is the number of edge lines.
+static bool readEdgeListStream(std::istream& file, const std::string& filename, std::vector<Vertex>& vertices,
+                        int& num_vertices, int& num_edges, GraphLoadStats& stats) {
+    std::vector<std::vector<std::pair<int, int>>> edge_buffers(1);
+    std::vector<std::pair<int, int>>& edges = edge_buffers[0];
+    std::vector<int> loop_ids; // Vertices of self-loops, kept when renumbering
+    long max_id = 0;
+    bool zero_based = false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#' || line[first] == '%') {
+            continue;
+        }
+        const char* cursor = line.c_str() + first;
+        const char* end = line.c_str() + line.size();
+        long u, v, weight;
+        if (!parseBoundedInt(cursor, end, u) || !parseBoundedInt(cursor, end, v) ||
+            (!atLineEnd(cursor, end) && (!parseBoundedInt(cursor, end, weight) || !atLineEnd(cursor, end)))) {
+            std::cerr << "Error: Malformed edge line '" << line << "' in '" << filename << "'" << std::endl;
+            return false;
+        }
+        stats.edge_lines++;
+        // Shifting 0-based IDs must leave n + 1 within int
+        if (u < 0 || v < 0 || u >= std::numeric_limits<int>::max() - 1 || v >= std::numeric_limits<int>::max() - 1) {
+            std::cerr << "Warning: Invalid vertex ID (" << u << ", " << v << ") in edge in '" << filename << "'" << std::endl;
+            stats.invalid_edges++;
+            continue;
+        }
+        max_id = std::max(max_id, std::max(u, v));
+        zero_based = zero_based || u == 0 || v == 0;
+        if (u == v) {
+            stats.self_loops++;
+            loop_ids.push_back(static_cast<int>(u));
+        } else {
+            edges.push_back({static_cast<int>(u), static_cast<int>(v)});
+        }
+    }
+
+    if (max_id > 2 * stats.edge_lines) {
+        // At least half of the IDs are unused: keep the used ones, in their order
+        std::vector<int> ids = std::move(loop_ids); // Vertices with only self-loops stay as isolated ones
+        ids.reserve(ids.size() + 2 * edges.size());
+        for (const std::pair<int, int>& edge : edges) {
+            ids.push_back(edge.first);
+            ids.push_back(edge.second);
+        }
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        for (std::pair<int, int>& edge : edges) {
+            edge.first = static_cast<int>(std::lower_bound(ids.begin(), ids.end(), edge.first) - ids.begin()) + 1;
+            edge.second = static_cast<int>(std::lower_bound(ids.begin(), ids.end(), edge.second) - ids.begin()) + 1;
+        }
+        std::cerr << "Warning: Sparse vertex IDs (largest " << max_id << ") in '" << filename << "' renumbered to 1.."
+                  << ids.size() << " in increasing order" << std::endl;
+        max_id = static_cast<long>(ids.size());
+    } else if (zero_based) {
+        for (std::pair<int, int>& edge : edges) {
+            edge.first++;
+            edge.second++;
+        }
+        max_id++;
+    }
+    num_vertices = static_cast<int>(max_id);
+    num_edges = static_cast<int>(std::min<long long>(stats.edge_lines, std::numeric_limits<int>::max()));
+    buildRowsFromEdgeBuffers(edge_buffers, num_vertices, vertices, stats, 1);
+    return true;
+}
+
+// Reads a graph in the given format from a stream that is consumed once
+static bool readGraphStream(std::istream& file, const std::string& filename, GraphFormat format, std::vector<Vertex>& vertices,
+                     int& num_vertices, int& num_edges, GraphLoadStats& stats) {
+    stats = GraphLoadStats();
+    vertices.clear(); // Clear any previous graph data before reading a new one
+    switch (format) {
+        case GraphFormat::DimacsBinary:
+            return readDimacsBinaryStream(file, filename, vertices, num_vertices, num_edges, stats);
+        case GraphFormat::Metis:
+            return readMetisStream(file, filename, vertices, num_vertices, num_edges, stats);
+        case GraphFormat::EdgeList:
+            return readEdgeListStream(file, filename, vertices, num_vertices, num_edges, stats);
+        default:
+            return readDimacsStream(file, filename, vertices, num_vertices, num_edges, stats);
+    }
+}
+
+// Function to parse the DIMACS graph file format (including .col extension)
+// DIMACS binary, METIS and edge list files are recognized by detectGraphFormat (unless a
+// format is given) and read by readGraphStream into the same layout and stats.
+// Files compressed with gzip, zstd or xz (e.g. .col.gz) are detected by their magic bytes
+// and decompressed on a second thread while parsing.
+// Plain text files are streamed twice: the first pass counts the degree of every vertex, so the
+// second one fills adjacency lists allocated with their exact size. Each list is then
+// sorted and made unique, so Vertex.degree is the degree in the simple graph: self-loops,
+// duplicated edges and out-of-range edges are dropped and counted in stats.
+// num_edges keeps the count declared by the 'p' line.
+static bool readGraphVertices(const std::string& filename, std::vector<Vertex>& vertices, int& num_vertices, int& num_edges,
+                   GraphLoadStats& stats, GraphFormat format = GraphFormat::Auto) {
+    Compression compression = detectCompression(filename);
+    if (format == GraphFormat::Auto) {
+        format = detectGraphFormat(filename, compression);
+    }
+    if (compression != Compression::None) {
+        std::unique_ptr<DecompressedSource> source = openDecompressedSource(filename, compression);
+        if (source == nullptr) {
+            std::cerr << "Error: No decoder available for compressed file '" << filename << "'" << std::endl;
+            return false;
+        }
+        DecompressingStreamBuffer buffer(std::move(source));
+        std::istream file(&buffer);
+        bool parsed = readGraphStream(file, filename, format, vertices, num_vertices, num_edges, stats);
+        if (buffer.failed()) {
+            std::cerr << "Error: Could not decompress '" << filename << "' (corrupt or truncated input)" << std::endl;
+            return false;
+        }
+        return parsed;
+    }
+    if (format != GraphFormat::Dimacs) {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not open file '" << filename << "'" << std::endl;
+            return false;
+        }
+        return readGraphStream(file, filename, format, vertices, num_vertices, num_edges, stats);
+    }
+
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file '" << filename << "'" << std::endl;
+        return false;
+    }
+
+    stats = GraphLoadStats();
+    vertices.clear(); // Clear any previous graph data before reading a new one
+    std::vector<int> slot_counts; // Adjacency entries per vertex, duplicates included
+
+    // Pass 1: count the adjacency entries of every vertex
+    auto is_valid_edge = [&num_vertices](long u, long v) {
+        return u > 0 && u <= num_vertices && v > 0 && v <= num_vertices;
+    };
+    bool parsed = scanDimacsLines(file, filename, num_vertices, num_edges,
+        [&]() {
+            slot_counts.assign(num_vertices + 1, 0);
+        },
+        [&](long u, long v) {
+            stats.edge_lines++;
+            if (!is_valid_edge(u, v)) {
+                std::cerr << "Warning: Invalid vertex ID (" << u << ", " << v << ") in edge in '" << filename << "'. Max vertex ID is " << num_vertices << std::endl;
+                stats.invalid_edges++;
+            } else if (u == v) {
+                stats.self_loops++;
+            } else {
+                slot_counts[u]++;
+                slot_counts[v]++;
+            }
+        });
+    if (!parsed) {
+        return false;
+    }
+
+    // Resize and initialize vertices. Using 1-indexing for convenience to match file format.
+    vertices.resize(num_vertices + 1);
+    for (int i = 1; i <= num_vertices; ++i) {
+        vertices[i].id = i;
+        vertices[i].neighbors.reserve(slot_counts[i]);
+    }
+
+    // Pass 2: fill the slots. Since it's an undirected graph, add to both adjacency lists.
+    file.clear();
+    file.seekg(0);
+    int declared_vertices = num_vertices;
+    parsed = scanDimacsLines(file, filename, num_vertices, num_edges,
+        [&]() {},
+        [&](long u, long v) {
+            if (is_valid_edge(u, v) && u != v) {
+                vertices[u].neighbors.push_back(static_cast<int>(v));
+                vertices[v].neighbors.push_back(static_cast<int>(u));
+            }
+        });
+    if (!parsed || num_vertices != declared_vertices) {
+        std::cerr << "Error: '" << filename << "' changed while it was being read" << std::endl;
+        return false;
+    }
+    file.close();
+
+    // Sort and unique every row to drop duplicated edges
+    long long removed_entries = 0;
+    long long kept_entries = 0;
+    for (int i = 1; i <= num_vertices; ++i) {
+        std::vector<int>& neighbors = vertices[i].neighbors;
+        std::sort(neighbors.begin(), neighbors.end());
+        size_t unique_size = std::unique(neighbors.begin(), neighbors.end()) - neighbors.begin();
+        removed_entries += neighbors.size() - unique_size;
+        neighbors.resize(unique_size);
+        vertices[i].degree = static_cast<int>(unique_size);
+        kept_entries += unique_size;
+    }
+    stats.duplicate_edges = removed_entries / 2; // Each duplicate appears in both rows
+    stats.simple_edges = kept_entries / 2;
+    return true;
+}
+
+// Edges and counters collected by one thread of readGraphVerticesParallel
+struct ParseChunkResult {
+    std::vector<std::pair<int, int>> edges; // Valid edges, self-loops excluded
+    std::vector<std::pair<long, long>> invalid_edges;
+    long long edge_lines = 0;
+    long long self_loops = 0;
+    bool malformed_edge = false;
+    bool extra_problem_line = false;
+};
+
+// Parallel variant of readGraphVertices for very large files. The file is memory mapped, the
+// header is scanned up to the 'p' line, and the rest is split at line boundaries into one
+// chunk per thread. Every thread parses its chunk into a local edge buffer; the degrees are
+// then counted with atomic increments, every row is allocated with its exact size and
+// filled in parallel, and the rows are sorted and made unique in parallel.
+// Produces exactly the graph and stats readGraphVertices produces (rows are sorted, so the
+// order in which threads fill them does not matter). Falls back to readGraphVertices for
+// compressed files and where mmap is not available.
+static bool readGraphVerticesParallel(const std::string& filename, std::vector<Vertex>& vertices, int& num_vertices, int& num_edges,
+                           GraphLoadStats& stats, int num_threads, GraphFormat format = GraphFormat::Auto) {
+#ifdef __linux__
+    Compression compression = detectCompression(filename);
+    if (format == GraphFormat::Auto) {
+        format = detectGraphFormat(filename, compression);
+    }
+    if (compression != Compression::None || format != GraphFormat::Dimacs) {
+        // Decompression is sequential and only DIMACS text is split into chunks
+        return readGraphVertices(filename, vertices, num_vertices, num_edges, stats, format);
+    }
+    int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Error: Could not open file '" << filename << "'" << std::endl;
+        return false;
+    }
+    struct stat file_status;
+    if (fstat(fd, &file_status) != 0) {
+        close(fd);
+        std::cerr << "Error: Could not open file '" << filename << "'" << std::endl;
+        return false;
+    }
+    size_t file_size = static_cast<size_t>(file_status.st_size);
+    const char* data = nullptr;
+    if (file_size > 0) {
+        void* mapping = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            return readGraphVertices(filename, vertices, num_vertices, num_edges, stats);
+        }
+        data = static_cast<const char*>(mapping);
+        madvise(mapping, file_size, MADV_SEQUENTIAL);
+    }
+    close(fd);
+    const char* const file_end = data + file_size;
+
+    struct Unmapper {
+        const char* data;
+        size_t size;
+        ~Unmapper() {
+            if (data != nullptr) {
+                munmap(const_cast<char*>(data), size);
+            }
+        }
+    } unmapper{data, file_size};
+
+    stats = GraphLoadStats();
+    vertices.clear(); // Clear any previous graph data before reading a new one
+
+    // Scan the header sequentially up to the problem line
+    const char* body = data;
+    bool problem_line_found = false;
+    while (body < file_end && !problem_line_found) {
+        const char* line_end = static_cast<const char*>(std::memchr(body, '\n', file_end - body));
+        if (line_end == nullptr) {
+            line_end = file_end;
+        }
+        const char* first = body;
+        while (first < line_end && (*first == ' ' || *first == '\t' || *first == '\r')) {
+            first++;
+        }
+        if (first < line_end && *first == 'e') {
+            std::cerr << "Error: 'e' line found before 'p' line in '" << filename << "'" << std::endl;
+            return false;
+        }
+        if (first < line_end && *first == 'p') {
+            std::istringstream iss(std::string(first + 1, line_end));
+            std::string problem_type;
+            if (!(iss >> problem_type >> num_vertices >> num_edges) || num_vertices < 0 || num_edges < 0) {
+                std::cerr << "Error: Malformed 'p' line in '" << filename << "'" << std::endl;
+                return false;
+            }
+            // Allow "edge" and "col" problem types for graph coloring benchmarks
+            if (problem_type != "edge" && problem_type != "col") {
+                std::cerr << "Error: Unsupported problem type '" << problem_type << "' in '" << filename << "'. Only 'edge' or 'col' types are supported by this parser." << std::endl;
+                return false;
+            }
+            problem_line_found = true;
+        }
+        body = line_end < file_end ? line_end + 1 : file_end;
+    }
+    if (!problem_line_found) {
+        std::cerr << "Error: No 'p' line found in '" << filename << "'" << std::endl;
+        return false;
+    }
+
+    // Split the body into chunks that start right after a newline
+    num_threads = std::max(1, num_threads);
+    std::vector<const char*> chunk_starts(num_threads + 1, file_end);
+    chunk_starts[0] = body;
+    for (int t = 1; t < num_threads; ++t) {
+        const char* split = body + (file_end - body) * t / num_threads;
+        split = std::max(split, chunk_starts[t - 1]);
+        const char* newline = static_cast<const char*>(std::memchr(split, '\n', file_end - split));
+        chunk_starts[t] = newline == nullptr ? file_end : newline + 1;
+    }
+
+    // Parse the chunks into thread-local edge buffers
+    std::vector<ParseChunkResult> chunk_results(num_threads);
+    const int n = num_vertices;
+    runOnThreads(num_threads, [&](int t) {
+        ParseChunkResult& result = chunk_results[t];
+        result.edges.reserve((chunk_starts[t + 1] - chunk_starts[t]) / 12); // About 12 bytes per "e u v" line
+        const char* cursor = chunk_starts[t];
+        const char* chunk_end = chunk_starts[t + 1];
+        while (cursor < chunk_end) {
+            const char* line_end = static_cast<const char*>(std::memchr(cursor, '\n', chunk_end - cursor));
+            if (line_end == nullptr) {
+                line_end = chunk_end;
+            }
+            while (cursor < line_end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r')) {
+                cursor++;
+            }
+            if (cursor < line_end && *cursor == 'e') {
+                cursor++;
+                long u, v;
+                if (!parseBoundedInt(cursor, line_end, u) || !parseBoundedInt(cursor, line_end, v)) {
+                    result.malformed_edge = true;
+                    return;
+                }
+                result.edge_lines++;
+                if (u <= 0 || u > n || v <= 0 || v > n) {
+                    result.invalid_edges.push_back({u, v});
+                } else if (u == v) {
+                    result.self_loops++;
+                } else {
+                    result.edges.push_back({static_cast<int>(u), static_cast<int>(v)});
+                }
+            } else if (cursor < line_end && *cursor == 'p') {
+                result.extra_problem_line = true;
+                return;
+            }
+            cursor = line_end + 1;
+        }
+    });
+
+    for (const ParseChunkResult& result : chunk_results) {
+        if (result.malformed_edge) {
+            std::cerr << "Error: Malformed 'e' line in '" << filename << "'" << std::endl;
+            return false;
+        }
+        if (result.extra_problem_line) {
+            std::cerr << "Error: More than one 'p' line in '" << filename << "'" << std::endl;
+            return false;
+        }
+        for (const auto& edge : result.invalid_edges) {
+            std::cerr << "Warning: Invalid vertex ID (" << edge.first << ", " << edge.second << ") in edge in '" << filename << "'. Max vertex ID is " << num_vertices << std::endl;
+        }
+        stats.edge_lines += result.edge_lines;
+        stats.self_loops += result.self_loops;
+        stats.invalid_edges += result.invalid_edges.size();
+    }
+
+    std::vector<std::vector<std::pair<int, int>>> edge_buffers(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+        edge_buffers[t].swap(chunk_results[t].edges);
+    }
+    buildRowsFromEdgeBuffers(edge_buffers, n, vertices, stats, num_threads);
+    return true;
+#else
+    (void)num_threads;
+    return readGraphVertices(filename, vertices, num_vertices, num_edges, stats, format);
+#endif
+}
+
+bool readGraphFile(const std::string& filename, Graph& graph, GraphLoadStats& stats, GraphFormat format, int num_threads) {
+    graph = Graph(); // Frees the previous graph before the new one is read
+    std::vector<Vertex> vertices;
+    int num_vertices = 0;
+    int num_edges = 0;
+    bool loaded = num_threads > 1
+                      ? readGraphVerticesParallel(filename, vertices, num_vertices, num_edges, stats, num_threads, format)
+                      : readGraphVertices(filename, vertices, num_vertices, num_edges, stats, format);
+    if (!loaded) {
+        return false;
+    }
+    graph = Graph(std::move(vertices), num_edges);
+    return true;
+}
+
+// Deterministic random number generator for the synthetic graph generators (SplitMix64).
+// Implemented here instead of using <random> distributions so that a given seed
+// produces the same graph with every compiler and standard library.
+class GraphRandom {
+public:
+    explicit GraphRandom(unsigned long long seed) : state_(seed) {}
+
+    unsigned long long next() {
+        unsigned long long z = (state_ += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform double in [0, 1)
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+    // Uniform integer in [0, bound)
+    int below(int bound) {
+        return static_cast<int>((static_cast<unsigned __int128>(next()) * static_cast<unsigned>(bound)) >> 64);
+    }
+
+private:
+    unsigned long long state_;
+};
+
+// Parses a generator spec. Returns false (with a message) for unknown families or keys.
+bool parseGeneratorSpec(const std::string& text, GraphGeneratorSpec& spec) {
+    size_t colon = text.find(':');
+    spec = GraphGeneratorSpec();
+    spec.family = text.substr(0, colon);
+    if (spec.family != "gnp" && spec.family != "geo" && spec.family != "leighton" && spec.family != "flat") {
+        std::cerr << "Error: Unknown graph family '" << spec.family << "'. Use gnp, geo, leighton or flat." << std::endl;
+        return false;
+    }
+
+    std::istringstream params(colon == std::string::npos ? "" : text.substr(colon + 1));
+    std::string param;
+    while (std::getline(params, param, ',')) {
+        size_t eq = param.find('=');
+        if (eq == std::string::npos) {
+            std::cerr << "Error: Malformed generator parameter '" << param << "'" << std::endl;
+            return false;
+        }
+        std::string key = param.substr(0, eq);
+        std::istringstream value(param.substr(eq + 1));
+        bool ok = false;
+        if (key == "n") {
+            ok = static_cast<bool>(value >> spec.n) && spec.n > 0;
+        } else if (key == "p") {
+            ok = static_cast<bool>(value >> spec.p) && spec.p >= 0.0 && spec.p <= 1.0;
+        } else if (key == "r") {
+            ok = static_cast<bool>(value >> spec.r) && spec.r >= 0.0;
+        } else if (key == "k") {
+            ok = static_cast<bool>(value >> spec.k) && spec.k > 0;
+        } else if (key == "m") {
+            ok = static_cast<bool>(value >> spec.m) && spec.m >= 0;
+        } else if (key == "seed") {
+            ok = static_cast<bool>(value >> spec.seed);
+        }
+        if (!ok) {
+            std::cerr << "Error: Invalid generator parameter '" << param << "'" << std::endl;
+            return false;
+        }
+    }
+    if ((spec.family == "leighton" || spec.family == "flat") && spec.k > spec.n) {
+        std::cerr << "Error: Planted colors k=" << spec.k << " exceed n=" << spec.n << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Human readable name of a generated graph, used where a file name would be printed
+std::string generatorSpecName(const GraphGeneratorSpec& spec) {
+    std::ostringstream name;
+    name << spec.family << "(n=" << spec.n;
+    if (spec.family == "gnp" || spec.family == "flat") {
+        name << ",p=" << spec.p;
+    }
+    if (spec.family == "geo") {
+        name << ",r=" << spec.r;
+    }
+    if (spec.family == "leighton" || spec.family == "flat") {
+        name << ",k=" << spec.k;
+    }
+    if (spec.family == "leighton") {
+        name << ",m=" << spec.m;
+    }
+    name << ",seed=" << spec.seed << ")";
+    return name.str();
+}
+
+// Calls add_pair(u, v) for every pair 0 <= v < u < n independently with probability p,
+// skipping over absent pairs geometrically (Batagelj and Brandes), so the cost is
+// proportional to the number of edges instead of n^2.
+template <typename AddPair>
+static void forEachRandomPair(int n, double p, GraphRandom& random, AddPair add_pair) {
+    if (p <= 0.0 || n < 2) {
+        return;
+    }
+    if (p >= 1.0) {
+        for (int u = 1; u < n; ++u) {
+            for (int v = 0; v < u; ++v) {
+                add_pair(u, v);
+            }
+        }
+        return;
+    }
+    const double log_q = std::log(1.0 - p);
+    long long u = 1;
+    long long v = -1;
+    while (u < n) {
+        v += 1 + static_cast<long long>(std::floor(std::log(1.0 - random.uniform()) / log_q));
+        while (v >= u && u < n) {
+            v -= u;
+            u++;
+        }
+        if (u < n) {
+            add_pair(static_cast<int>(u), static_cast<int>(v));
+        }
+    }
+}
+
+// Assigns n vertices to k classes of (almost) equal size in random order.
+static std::vector<int> plantedPartition(int n, int k, GraphRandom& random) {
+    std::vector<int> planted_color(n);
+    for (int i = 0; i < n; ++i) {
+        planted_color[i] = i % k;
+    }
+    for (int i = n - 1; i > 0; --i) {
+        std::swap(planted_color[i], planted_color[random.below(i + 1)]);
+    }
+    return planted_color;
+}
+
+// Sorts the neighbor lists, drops parallel edges and recomputes degrees.
+// Returns the number of distinct undirected edges.
+static long long finalizeGeneratedGraph(std::vector<Vertex>& vertices, int num_vertices) {
+    long long adjacency_entries = 0;
+    for (int i = 1; i <= num_vertices; ++i) {
+        std::vector<int>& neighbors = vertices[i].neighbors;
+        std::sort(neighbors.begin(), neighbors.end());
+        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+        vertices[i].degree = static_cast<int>(neighbors.size());
+        adjacency_entries += neighbors.size();
+    }
+    return adjacency_entries / 2;
+}
+
+// Builds a synthetic graph in memory with the same vertex layout readGraphFile produces
+// (1-indexed, undirected adjacency lists), so it feeds the engines without any text.
+//   gnp:      G(n, p) uniform random graph, like the dsjc family
+//   geo:      random geometric graph in the unit square with radius r, like the r/dsjr family
+//   leighton: union of cliques over a planted k-coloring with about m edges, containing a
+//             k-clique so the chromatic number is exactly k, like the le450 family
+//   flat:     random k-partite graph over a planted equitable k-coloring, each pair of
+//             vertices in different classes adjacent with probability p, like the flat family
+// num_edges receives the number of distinct edges generated.
+static void generateVertices(const GraphGeneratorSpec& spec, std::vector<Vertex>& vertices, int& num_vertices, int& num_edges) {
+    GraphRandom random(spec.seed);
+    num_vertices = spec.n;
+    vertices.clear();
+    vertices.resize(num_vertices + 1);
+    for (int i = 1; i <= num_vertices; ++i) {
+        vertices[i].id = i;
+    }
+    // Generators work with 0-based vertices internally
+    std::vector<int> degrees; // Filled instead of the rows during a counting pass
+    bool counting = false;
+    auto add_edge = [&](int u, int v) {
+        if (counting) {
+            degrees[u + 1]++;
+            degrees[v + 1]++;
+            return;
+        }
+        vertices[u + 1].neighbors.push_back(v + 1);
+        vertices[v + 1].neighbors.push_back(u + 1);
+    };
+    // gnp, flat and geo produce every edge once, so their edge loop runs twice over the
+    // same random stream: the first pass counts the degrees and the second fills rows
+    // allocated with their exact size, instead of growing every row edge by edge.
+    auto generate_in_two_passes = [&](auto generate_edges) {
+        GraphRandom replay = random;
+        degrees.assign(num_vertices + 1, 0);
+        counting = true;
+        generate_edges(replay);
+        counting = false;
+        for (int i = 1; i <= num_vertices; ++i) {
+            vertices[i].neighbors.reserve(degrees[i]);
+        }
+        generate_edges(random);
+    };
+
+    if (spec.family == "gnp") {
+        generate_in_two_passes([&](GraphRandom& pass_random) { forEachRandomPair(spec.n, spec.p, pass_random, add_edge); });
+    } else if (spec.family == "flat") {
+        std::vector<int> planted_color = plantedPartition(spec.n, spec.k, random);
+        generate_in_two_passes([&](GraphRandom& pass_random) {
+            forEachRandomPair(spec.n, spec.p, pass_random, [&](int u, int v) {
+                if (planted_color[u] != planted_color[v]) {
+                    add_edge(u, v);
+                }
+            });
+        });
+    } else if (spec.family == "geo") {
+        // Bucket the points in a grid of cells of side >= r, so only adjacent cells are compared
+        std::vector<double> x(spec.n), y(spec.n);
+        for (int i = 0; i < spec.n; ++i) {
+            x[i] = random.uniform();
+            y[i] = random.uniform();
+        }
+        int cells_per_side = spec.r > 0.0 ? std::max(1, std::min(4096, static_cast<int>(1.0 / spec.r))) : 1;
+        size_t num_cells = static_cast<size_t>(cells_per_side) * cells_per_side;
+        auto cell_of = [cells_per_side](double coordinate) {
+            return std::min(cells_per_side - 1, static_cast<int>(coordinate * cells_per_side));
+        };
+        // Points grouped by cell (counting sort): cell c holds cell_points[cell_start[c] .. cell_start[c + 1])
+        std::vector<int> cell_start(num_cells + 1, 0);
+        std::vector<int> cell_points(spec.n);
+        for (int i = 0; i < spec.n; ++i) {
+            cell_start[static_cast<size_t>(cell_of(y[i])) * cells_per_side + cell_of(x[i]) + 1]++;
+        }
+        std::partial_sum(cell_start.begin(), cell_start.end(), cell_start.begin());
+        std::vector<int> cell_fill(cell_start.begin(), cell_start.end() - 1);
+        for (int i = 0; i < spec.n; ++i) {
+            cell_points[cell_fill[static_cast<size_t>(cell_of(y[i])) * cells_per_side + cell_of(x[i])]++] = i;
+        }
+        const double r_squared = spec.r * spec.r;
+        generate_in_two_passes([&](GraphRandom&) {
+            for (int i = 0; i < spec.n; ++i) {
+                int cx = cell_of(x[i]);
+                int cy = cell_of(y[i]);
+                for (int ny = std::max(0, cy - 1); ny <= std::min(cells_per_side - 1, cy + 1); ++ny) {
+                    for (int nx = std::max(0, cx - 1); nx <= std::min(cells_per_side - 1, cx + 1); ++nx) {
+                        size_t cell = static_cast<size_t>(ny) * cells_per_side + nx;
+                        for (int k = cell_start[cell]; k < cell_start[cell + 1]; ++k) {
+                            int j = cell_points[k];
+                            double dx = x[i] - x[j];
+                            double dy = y[i] - y[j];
+                            if (j < i && dx * dx + dy * dy <= r_squared) {
+                                add_edge(i, j);
+                            }
+                        }
+                    }
+                }
+            }
+        });
+    } else if (spec.family == "leighton") {
+        std::vector<int> planted_color = plantedPartition(spec.n, spec.k, random);
+        std::vector<std::vector<int>> classes(spec.k);
+        for (int i = 0; i < spec.n; ++i) {
+            classes[planted_color[i]].push_back(i);
+        }
+        std::vector<int> class_order(spec.k);
+        std::iota(class_order.begin(), class_order.end(), 0);
+        std::vector<int> clique;
+        // Cliques of size s are drawn with weight 1 / (s (s - 1) / 2), so every size from
+        // 2 to k contributes about the same number of edges, as in Leighton's construction.
+        std::vector<double> size_weights(spec.k + 1, 0.0);
+        double total_weight = 0.0;
+        for (int s = 2; s <= spec.k; ++s) {
+            size_weights[s] = 2.0 / (static_cast<double>(s) * (s - 1));
+            total_weight += size_weights[s];
+        }
+
+        auto add_clique = [&](int size) {
+            // Partial Fisher-Yates over the classes: one vertex from each of `size` distinct classes
+            clique.clear();
+            for (int c = 0; c < size; ++c) {
+                std::swap(class_order[c], class_order[c + random.below(spec.k - c)]);
+                const std::vector<int>& members = classes[class_order[c]];
+                clique.push_back(members[random.below(static_cast<int>(members.size()))]);
+            }
+            for (size_t a = 0; a < clique.size(); ++a) {
+                for (size_t b = 0; b < a; ++b) {
+                    add_edge(clique[a], clique[b]);
+                }
+            }
+        };
+
+        add_clique(spec.k); // Forces the chromatic number to be exactly k
+        long long target_edges = std::max<long long>(spec.m, static_cast<long long>(spec.k) * (spec.k - 1) / 2);
+        long long distinct_edges = finalizeGeneratedGraph(vertices, num_vertices);
+        // Cliques overlap, so generate in rounds until the distinct edge count reaches m
+        while (distinct_edges < target_edges) {
+            long long raw_edges = 0;
+            while (raw_edges < target_edges - distinct_edges) {
+                double pick = random.uniform() * total_weight;
+                int size = 2;
+                while (size < spec.k && pick >= size_weights[size]) {
+                    pick -= size_weights[size];
+                    size++;
+                }
+                add_clique(size);
+                raw_edges += static_cast<long long>(size) * (size - 1) / 2;
+            }
+            long long previous_edges = distinct_edges;
+            distinct_edges = finalizeGeneratedGraph(vertices, num_vertices);
+            if (distinct_edges == previous_edges) {
+                break; // Saturated: every edge allowed by the planted coloring exists
+            }
+        }
+    }
+
+    num_edges = static_cast<int>(finalizeGeneratedGraph(vertices, num_vertices));
+}
+
+void generateGraph(const GraphGeneratorSpec& spec, Graph& graph) {
+    graph = Graph();
+    std::vector<Vertex> vertices;
+    int num_vertices = 0;
+    int num_edges = 0;
+    generateVertices(spec, vertices, num_vertices, num_edges);
+    graph = Graph(std::move(vertices), num_edges);
+}
+
+size_t graphMemoryBytes(const Graph& graph) {
+    return graph.offsets_.capacity() * sizeof(size_t) + graph.narrow_.capacity() * sizeof(uint16_t) +
+           graph.wide_.capacity() * sizeof(uint32_t) + graph.packed_.capacity() +
+           graph.block_offsets_.capacity() * sizeof(uint64_t) + graph.row_offsets_.capacity() * sizeof(uint32_t);
+}
+
+GraphCache::GraphCache(size_t byte_budget) : byte_budget_(byte_budget) {
+    stats_.byte_budget = byte_budget;
+}
+
+CachedGraph GraphCache::load(const std::string& filename, GraphFormat format, int num_threads) {
+    std::error_code error;
+    auto modified = std::filesystem::last_write_time(filename, error);
+    std::uintmax_t file_size = error ? 0 : std::filesystem::file_size(filename, error);
+    if (error) {
+        CachedGraph result;
+        result.error = "cannot access '" + filename + "': " + error.message();
+        return result;
+    }
+    long long modified_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(modified.time_since_epoch()).count();
+    return getOrBuild(graphFormatName(format) + ":" + filename, modified_ns, static_cast<long long>(file_size),
+                      [&](Graph& graph, GraphLoadStats& stats) {
+                          return readGraphFile(filename, graph, stats, format, num_threads);
+                      });
+}
+
+// Cache key of a generated graph: every parameter, with p and r in full precision, since
+// generatorSpecName rounds them for display
+static std::string generatorSpecKey(const GraphGeneratorSpec& spec) {
+    std::ostringstream key;
+    key << std::setprecision(std::numeric_limits<double>::max_digits10) << spec.family << "(n=" << spec.n
+        << ",p=" << spec.p << ",r=" << spec.r << ",k=" << spec.k << ",m=" << spec.m << ",seed=" << spec.seed << ")";
+    return key.str();
+}
+
+CachedGraph GraphCache::generate(const GraphGeneratorSpec& spec) {
+    return getOrBuild("generate:" + generatorSpecKey(spec), 0, 0, [&](Graph& graph, GraphLoadStats&) {
+        generateGraph(spec, graph);
+        return true;
+    });
+}
+
+CachedGraph GraphCache::getOrBuild(const std::string& key, long long modified_ns, long long file_size,
+                                   const std::function<bool(Graph&, GraphLoadStats&)>& build) {
+    std::promise<CachedGraph> promise;
+    long long load_id;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto found = entries_.find(key);
+        if (found != entries_.end() && found->second.modified_ns == modified_ns && found->second.file_size == file_size) {
+            lru_.splice(lru_.begin(), lru_, found->second.lru_position);
+            std::shared_future<CachedGraph> result = found->second.result;
+            ++stats_.hits;
+            lock.unlock();
+            CachedGraph cached = result.get(); // Waits if the graph is still being loaded
+            cached.hit = cached.graph != nullptr;
+            cached.load_ms = 0.0;
+            return cached;
+        }
+        if (found != entries_.end()) {
+            // The file changed since it was cached
+            stats_.bytes -= found->second.bytes;
+            lru_.erase(found->second.lru_position);
+            entries_.erase(found);
+        }
+        load_id = next_load_id_++;
+        lru_.push_front(key);
+        entries_[key] = Entry{modified_ns, file_size, load_id, promise.get_future().share(), false, 0, lru_.begin()};
+        ++stats_.misses;
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+    CachedGraph cached;
+    std::shared_ptr<Graph> graph;
+    bool built = false;
+    std::string failure;
+    try {
+        graph = std::make_shared<Graph>();
+        built = build(*graph, cached.load_stats);
+    } catch (const std::exception& e) {
+        // E.g. bad_alloc for a graph too large for memory: handed to every waiter as an
+        // error, and the entry is dropped below so that a later lookup tries again
+        graph.reset();
+        failure = std::string(": ") + e.what();
+    }
+    cached.load_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+    if (built) {
+        cached.graph = graph;
+    } else {
+        cached.error = "could not read graph '" + key.substr(key.find(':') + 1) + "'" + failure;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto found = entries_.find(key);
+        if (found != entries_.end() && found->second.load_id == load_id) {
+            size_t bytes = built ? graphMemoryBytes(*graph) : 0;
+            if (built && bytes <= byte_budget_) {
+                found->second.loaded = true;
+                found->second.bytes = bytes;
+                stats_.bytes += bytes;
+                evictToBudget();
+            } else {
+                // Not kept: too large for the budget, or a later lookup tries again
+                lru_.erase(found->second.lru_position);
+                entries_.erase(found);
+            }
+        }
+    }
+    promise.set_value(cached);
+    return cached;
+}
+
+void GraphCache::evictToBudget() {
+    auto position = lru_.end();
+    while (stats_.bytes > byte_budget_ && position != lru_.begin()) {
+        --position;
+        auto found = entries_.find(*position);
+        if (!found->second.loaded) {
+            continue;
+        }
+        stats_.bytes -= found->second.bytes;
+        ++stats_.evictions;
+        entries_.erase(found);
+        position = lru_.erase(position);
+    }
+}
+
+GraphCacheStats GraphCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    GraphCacheStats stats = stats_;
+    stats.graphs = 0;
+    for (const auto& entry : entries_) {
+        stats.graphs += entry.second.loaded ? 1 : 0;
+    }
+    return stats;
+}
+
+void GraphCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto entry = entries_.begin(); entry != entries_.end();) {
+        if (entry->second.loaded) {
+            stats_.bytes -= entry->second.bytes;
+            lru_.erase(entry->second.lru_position);
+            entry = entries_.erase(entry);
+        } else {
+            ++entry;
+        }
+    }
+}
+
+// Parses the command line name of a relabeling order. Returns false if unknown.
+bool parseRelabelOrder(const std::string& name, RelabelOrder& order) {
+    if (name == "none") {
+        order = RelabelOrder::None;
+    } else if (name == "rcm") {
+        order = RelabelOrder::RCM;
+    } else if (name == "degree") {
+        order = RelabelOrder::DegreeDescending;
+    } else if (name == "bfs") {
+        order = RelabelOrder::BFS;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string relabelOrderName(RelabelOrder order) {
+    switch (order) {
+        case RelabelOrder::RCM: return "RCM";
+        case RelabelOrder::DegreeDescending: return "degree";
+        case RelabelOrder::BFS: return "BFS";
+        default: return "none";
+    }
+}
+
+// Computes the new vertex sequence for the given ordering.
+// new_order[k] holds the current ID of the vertex that becomes vertex k + 1.
+static std::vector<int> computeRelabelOrder(const std::vector<Vertex>& vertices, int num_vertices, RelabelOrder order) {
+    std::vector<int> new_order(num_vertices);
+    std::iota(new_order.begin(), new_order.end(), 1);
+
+    if (order == RelabelOrder::DegreeDescending) {
+        std::stable_sort(new_order.begin(), new_order.end(),
+                         [&vertices](int a, int b) {
+                             return vertices[a].degree > vertices[b].degree;
+                         });
+        return new_order;
+    }
+    if (order != RelabelOrder::RCM && order != RelabelOrder::BFS) {
+        return new_order; // RelabelOrder::None keeps the identity
+    }
+
+    // Both RCM and BFS traverse every connected component breadth-first.
+    // RCM starts each component at a vertex of minimum degree, visits neighbors
+    // in increasing degree order and reverses the final sequence.
+    // BFS starts at the lowest unvisited ID and keeps adjacency order.
+    std::vector<int> start_candidates = new_order;
+    if (order == RelabelOrder::RCM) {
+        std::stable_sort(start_candidates.begin(), start_candidates.end(),
+                         [&vertices](int a, int b) {
+                             return vertices[a].degree < vertices[b].degree;
+                         });
+    }
+
+    std::vector<bool> visited(num_vertices + 1, false);
+    std::vector<int> level_neighbors; // Neighbors discovered from the vertex being expanded
+    int head = 0; // new_order doubles as the BFS queue
+    int tail = 0;
+
+    for (int start : start_candidates) {
+        if (visited[start]) {
+            continue;
+        }
+        visited[start] = true;
+        new_order[tail++] = start;
+
+        while (head < tail) {
+            int u = new_order[head++];
+            level_neighbors.clear();
+            for (int neighbor_id : vertices[u].neighbors) {
+                if (!visited[neighbor_id]) {
+                    visited[neighbor_id] = true;
+                    level_neighbors.push_back(neighbor_id);
+                }
+            }
+            if (order == RelabelOrder::RCM) {
+                std::stable_sort(level_neighbors.begin(), level_neighbors.end(),
+                                 [&vertices](int a, int b) {
+                                     return vertices[a].degree < vertices[b].degree;
+                                 });
+            }
+            for (int neighbor_id : level_neighbors) {
+                new_order[tail++] = neighbor_id;
+            }
+        }
+    }
+
+    if (order == RelabelOrder::RCM) {
+        std::reverse(new_order.begin(), new_order.end());
+    }
+    return new_order;
+}
+
+// Renumbers the graph in place according to the requested ordering.
+// original_ids[new_id] receives the ID the vertex had in the file, so results
+// can always be reported in the original numbering. Neighbor lists are sorted
+// by the new IDs, which keeps every neighbor scan moving forward in memory.
+static void relabelVertices(std::vector<Vertex>& vertices, int num_vertices, RelabelOrder order, std::vector<int>& original_ids) {
+    original_ids.assign(num_vertices + 1, 0);
+    std::iota(original_ids.begin(), original_ids.end(), 0);
+    if (order == RelabelOrder::None) {
+        return;
+    }
+
+    std::vector<int> new_order = computeRelabelOrder(vertices, num_vertices, order);
+    std::vector<int> old_to_new(num_vertices + 1, 0);
+    for (int k = 0; k < num_vertices; ++k) {
+        old_to_new[new_order[k]] = k + 1;
+    }
+
+    std::vector<Vertex> relabeled(num_vertices + 1);
+    for (int new_id = 1; new_id <= num_vertices; ++new_id) {
+        int old_id = new_order[new_id - 1];
+        Vertex& target = relabeled[new_id];
+        target = std::move(vertices[old_id]);
+        target.id = new_id;
+        for (int& neighbor_id : target.neighbors) {
+            neighbor_id = old_to_new[neighbor_id];
+        }
+        std::sort(target.neighbors.begin(), target.neighbors.end());
+        original_ids[new_id] = old_id;
+    }
+    vertices.swap(relabeled);
+}
+
+void relabelGraph(Graph& graph, RelabelOrder order, std::vector<int>& original_ids) {
+    int num_vertices = graph.numVertices();
+    int num_edges = graph.numEdges();
+    std::vector<Vertex> vertices = graph.release();
+    relabelVertices(vertices, num_vertices, order, original_ids);
+    graph = Graph(std::move(vertices), num_edges);
+}
+
+NeighborLocality measureNeighborLocality(const Graph& graph) {
+    NeighborLocality locality;
+    long long gap_sum = 0;
+    long long entries = 0;
+    graph.visit([&](const auto& view) {
+        for (int u = 1; u <= view.numVertices(); ++u) {
+            for (int neighbor_id : view.neighbors(u)) {
+                int gap = std::abs(u - neighbor_id);
+                locality.bandwidth = std::max(locality.bandwidth, gap);
+                gap_sum += gap;
+                entries++;
+            }
+        }
+    });
+    if (entries > 0) {
+        locality.mean_gap = static_cast<double>(gap_sum) / entries;
+    }
+    return locality;
+}
+
+// Writes a coloring in DIMACS solution format ("s col K" followed by one
+// "l <vertex> <color>" line per vertex), using the original vertex IDs from the
+// file and 1-based colors.
+bool writeColoringFile(const std::string& filename, const ColoringResult& result, const std::vector<int>& original_ids) {
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+        std::cerr << "Error: Could not open coloring file '" << filename << "'" << std::endl;
+        return false;
+    }
+
+    int num_vertices = static_cast<int>(result.colors.size()) - 1;
+    std::vector<int> color_by_original_id(num_vertices + 1, -1);
+    for (int i = 1; i <= num_vertices; ++i) {
+        color_by_original_id[original_ids[i]] = result.colors[i];
+    }
+
+    out << "s col " << result.colors_used << "\n";
+    for (int v = 1; v <= num_vertices; ++v) {
+        out << "l " << v << " " << color_by_original_id[v] + 1 << "\n";
+    }
+    return true;
+}
+
+
+const char* tracePhaseName(int phase) {
+    static const char* const names[NumTracePhases] = {
+        "ordering", "heuristic evaluation", "vertex selection", "color search", "uncolored removal", "set update",
+    };
+    return names[phase];
+}
+
+#ifdef GC_TRACE
+// State shared by the tracers of all threads
+struct TraceRegistry {
+    std::mutex mutex;                        // Guards the members up to run_names
+    std::vector<PhaseTracer*> tracers;       // Of the threads alive
+    std::vector<PhaseTracer::Event> retired; // Events of the threads that have exited
+    std::vector<std::string> run_names;
+    std::atomic<bool> events_enabled{false};
+    std::atomic<long long> free_events{0};   // Events left before dropping, over all threads
+    std::atomic<long long> dropped_events{0};
+    std::atomic<int> next_tid{1};
+    const PhaseTracer::Clock::time_point epoch = PhaseTracer::Clock::now(); // Common time base
+
+    static TraceRegistry& instance() {
+        static TraceRegistry registry;
+        return registry;
+    }
+    static const std::vector<PhaseTracer::Event>& events(const PhaseTracer& tracer) { return tracer.events_; }
+};
+
+PhaseTracer& PhaseTracer::current() {
+    thread_local PhaseTracer tracer;
+    return tracer;
+}
+
+PhaseTracer::PhaseTracer() : tid_(0) {
+    resetTotals();
+    TraceRegistry& registry = TraceRegistry::instance();
+#ifdef __linux__
+    tid_ = static_cast<int>(syscall(SYS_gettid));
+#else
+    tid_ = registry.next_tid++;
+#endif
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.tracers.push_back(this);
+}
+
+PhaseTracer::~PhaseTracer() {
+    // The thread exits: its events stay for writeChromeTrace
+    TraceRegistry& registry = TraceRegistry::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.tracers.erase(std::find(registry.tracers.begin(), registry.tracers.end(), this));
+    registry.retired.insert(registry.retired.end(), events_.begin(), events_.end());
+}
+
+void PhaseTracer::resetTotals() {
+    for (int p = 0; p < NumTracePhases; ++p) {
+        total_ns_[p] = 0;
+        scopes_[p] = 0;
+        ops_[p] = 0;
+    }
+}
+
+void PhaseTracer::record(int phase, Clock::time_point start, Clock::time_point end) {
+    total_ns_[phase] += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    scopes_[phase]++;
+    addEvent(phase, start, end);
+}
+
+void PhaseTracer::enableEvents(size_t max_events) {
+    TraceRegistry& registry = TraceRegistry::instance();
+    registry.free_events = static_cast<long long>(std::min<size_t>(max_events, std::numeric_limits<long long>::max()));
+    registry.events_enabled = true;
+}
+
+void PhaseTracer::recordRun(const std::string& name, double elapsed_ms) {
+    Clock::time_point end = Clock::now();
+    Clock::time_point start = end - std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(elapsed_ms));
+    TraceRegistry& registry = TraceRegistry::instance();
+    int index;
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.run_names.push_back(name);
+        index = static_cast<int>(registry.run_names.size());
+    }
+    addEvent(-index, start, end);
+}
+
+std::string PhaseTracer::formatTotals() const {
+    std::ostringstream out;
+    bool first = true;
+    for (int p = 0; p < NumTracePhases; ++p) {
+        if (scopes_[p] == 0) {
+            continue;
+        }
+        if (!first) {
+            out << "\n";
+        }
+        first = false;
+        out << "    Phase " << tracePhaseName(p) << ": " << total_ns_[p] / 1e6 << " ms in "
+            << scopes_[p] << " scopes, " << ops_[p] << " ops";
+    }
+    return out.str();
+}
+
+bool PhaseTracer::writeChromeTrace(const std::string& filename) {
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+        std::cerr << "Error: Could not open trace file '" << filename << "'" << std::endl;
+        return false;
+    }
+    TraceRegistry& registry = TraceRegistry::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    long long pid = getpid();
+    bool first = true;
+    auto write_events = [&](const std::vector<Event>& events) {
+        for (const Event& event : events) {
+            std::string name = event.phase >= 0 ? tracePhaseName(event.phase) : registry.run_names[-event.phase - 1];
+            out << (first ? "\n" : ",\n") << "{\"name\":\"" << name << "\",\"cat\":\""
+                << (event.phase >= 0 ? "phase" : "run") << "\",\"ph\":\"X\",\"ts\":" << event.ts_us
+                << ",\"dur\":" << event.dur_us << ",\"pid\":" << pid << ",\"tid\":" << event.tid << "}";
+            first = false;
+        }
+    };
+    out << "{\"traceEvents\":[";
+    write_events(registry.retired);
+    for (const PhaseTracer* tracer : registry.tracers) {
+        write_events(TraceRegistry::events(*tracer));
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":" << registry.dropped_events << "}}\n";
+    return true;
+}
+
+void PhaseTracer::addEvent(int phase, Clock::time_point start, Clock::time_point end) {
+    TraceRegistry& registry = TraceRegistry::instance();
+    if (!registry.events_enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    if (registry.free_events.fetch_sub(1, std::memory_order_relaxed) <= 0) {
+        registry.dropped_events.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    events_.push_back({phase, tid_,
+                       std::chrono::duration<double, std::micro>(start - registry.epoch).count(),
+                       std::chrono::duration<double, std::micro>(end - start).count()});
+}
+
+// Adds the lifetime of the scope to the given phase of the current thread's tracer
+class ScopedPhaseTimer {
+public:
+    explicit ScopedPhaseTimer(int phase) : phase_(phase), start_(PhaseTracer::Clock::now()) {}
+    ~ScopedPhaseTimer() { PhaseTracer::current().record(phase_, start_, PhaseTracer::Clock::now()); }
+
+private:
+    int phase_;
+    PhaseTracer::Clock::time_point start_;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_PHASE(phase) ScopedPhaseTimer TRACE_CONCAT(trace_scope_, __LINE__)(phase)
+#define TRACE_OPS(phase, n) PhaseTracer::current().addOps(phase, n)
+#else
+#define TRACE_PHASE(phase) do {} while (0)
+#define TRACE_OPS(phase, n) do {} while (0)
+#endif
+
+// Bump allocator: memory is handed out from a list of blocks by advancing an offset and
+// given back all at once by rewinding to an earlier mark. Blocks are kept for reuse, so
+// once the arena has grown to the high-water mark of a workload it stops allocating.
+class Arena {
+public:
+    struct Mark {
+        size_t block;
+        size_t offset;
+    };
+
+    explicit Arena(size_t min_block_bytes) : min_block_bytes_(min_block_bytes) {}
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t bytes, size_t alignment) {
+        while (true) {
+            if (current_ < blocks_.size()) {
+                uintptr_t base = reinterpret_cast<uintptr_t>(blocks_[current_].data.get());
+                uintptr_t start = (base + offset_ + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+                if (start + bytes <= base + blocks_[current_].size) {
+                    offset_ = start + bytes - base;
+                    return reinterpret_cast<void*>(start);
+                }
+                if (current_ + 1 < blocks_.size()) {
+                    ++current_; // Try the next block kept from an earlier run
+                    offset_ = 0;
+                    continue;
+                }
+            }
+            addBlock(bytes + alignment);
+        }
+    }
+
+    // Only the most recent allocation is actually given back; the rest waits for a rewind
+    void deallocate(void* pointer, size_t bytes) {
+        if (current_ < blocks_.size()) {
+            char* base = blocks_[current_].data.get();
+            if (static_cast<char*>(pointer) + bytes == base + offset_) {
+                offset_ = static_cast<size_t>(static_cast<char*>(pointer) - base);
+            }
+        }
+    }
+
+    bool owns(const void* pointer) const {
+        for (const Block& block : blocks_) {
+            const char* base = block.data.get();
+            if (pointer >= base && pointer < base + block.size) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Mark mark() const { return Mark{current_, offset_}; }
+    void rewind(Mark mark) {
+        current_ = mark.block;
+        offset_ = mark.offset;
+    }
+
+    // Replaces several blocks by a single one of their total size. Only valid when
+    // nothing is allocated, i.e. after rewinding to the first mark.
+    void coalesce() {
+        if (blocks_.size() > 1 && current_ == 0 && offset_ == 0) {
+            size_t total = reservedBytes();
+            blocks_.clear();
+            addBlock(total);
+        }
+    }
+
+    // Frees every block. Only valid when nothing is allocated.
+    void release() {
+        blocks_.clear();
+        current_ = 0;
+        offset_ = 0;
+    }
+
+    size_t reservedBytes() const {
+        size_t total = 0;
+        for (const Block& block : blocks_) {
+            total += block.size;
+        }
+        return total;
+    }
+    long long blockAllocations() const { return block_allocations_; }
+
+    int scope_depth = 0; // Open ScratchScopes on this arena
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    void addBlock(size_t min_bytes) {
+        size_t size = std::max(min_block_bytes_, min_bytes);
+        if (!blocks_.empty()) {
+            size = std::max(size, blocks_.back().size * 2);
+        }
+        blocks_.push_back(Block{std::unique_ptr<char[]>(new char[size]), size});
+        current_ = blocks_.size() - 1;
+        offset_ = 0;
+        ++block_allocations_;
+    }
+
+    size_t min_block_bytes_;
+    std::vector<Block> blocks_;
+    size_t current_ = 0; // Block of the next allocation
+    size_t offset_ = 0;  // Bytes used in that block
+    long long block_allocations_ = 0;
+};
+
+// Per-thread arena of the coloring engines' temporary arrays
+static Arena& scratchArena() {
+    thread_local Arena arena(size_t(64) << 10);
+    return arena;
+}
+
+// Opened at the start of an engine run: every scratch allocation made while it is open
+// is given back when it closes, and the outermost scope merges the blocks the run had to
+// add, so the next run of a similar size allocates nothing. Declare it before any
+// ScratchVector of the run, so it closes after they are gone.
+class ScratchScope {
+public:
+    ScratchScope() : arena_(scratchArena()), mark_(arena_.mark()) { arena_.scope_depth++; }
+    ~ScratchScope() {
+        arena_.rewind(mark_);
+        if (--arena_.scope_depth == 0) {
+            arena_.coalesce();
+        }
+    }
+    ScratchScope(const ScratchScope&) = delete;
+    ScratchScope& operator=(const ScratchScope&) = delete;
+
+private:
+    Arena& arena_;
+    Arena::Mark mark_;
+};
+
+// std::allocator replacement that takes memory from the scratch arena of the thread that
+// created it while a ScratchScope is open there, and from the heap otherwise. Containers
+// using it must stay on that thread.
+template <typename T>
+struct ScratchAllocator {
+    using value_type = T;
+
+    ScratchAllocator() : arena(&scratchArena()) {}
+    template <typename U>
+    ScratchAllocator(const ScratchAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) {
+        if (arena->scope_depth > 0) {
+            return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    void deallocate(T* pointer, size_t n) {
+        if (arena->owns(pointer)) {
+            arena->deallocate(pointer, n * sizeof(T));
+        } else {
+            ::operator delete(pointer);
+        }
+    }
+
+    Arena* arena;
+};
+
+template <typename T, typename U>
+bool operator==(const ScratchAllocator<T>& a, const ScratchAllocator<U>& b) { return a.arena == b.arena; }
+template <typename T, typename U>
+bool operator!=(const ScratchAllocator<T>& a, const ScratchAllocator<U>& b) { return a.arena != b.arena; }
+
+template <typename T>
+using ScratchVector = std::vector<T, ScratchAllocator<T>>;
+
+ScratchMemoryStats scratchMemoryStats() {
+    ScratchMemoryStats stats;
+    stats.reserved_bytes = scratchArena().reservedBytes();
+    stats.block_allocations = scratchArena().blockAllocations();
+    return stats;
+}
+
+void releaseScratchMemory() {
+    if (scratchArena().scope_depth == 0) {
+        scratchArena().release();
+    }
+}
+
+// Index of the lowest zero bit in words[0..num_words), or num_words * 64 if all are set.
+// Whole vectors of full words are skipped with AVX-512 or AVX2 when compiled in.
+static int findFirstZeroBit(const uint64_t* words, size_t num_words) {
+    size_t i = 0;
+#if defined(__AVX512F__)
+    const __m512i all_ones = _mm512_set1_epi64(-1);
+    for (; i + 8 <= num_words; i += 8) {
+        __mmask8 not_full = _mm512_cmpneq_epu64_mask(_mm512_loadu_si512(words + i), all_ones);
+        if (not_full != 0) {
+            i += __builtin_ctz(not_full);
+            break;
+        }
+    }
+#elif defined(__AVX2__)
+    const __m256i all_ones = _mm256_set1_epi64x(-1);
+    for (; i + 4 <= num_words; i += 4) {
+        __m256i full = _mm256_cmpeq_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i)), all_ones);
+        int full_words = _mm256_movemask_pd(_mm256_castsi256_pd(full));
+        if (full_words != 0xF) {
+            i += __builtin_ctz(~full_words);
+            break;
+        }
+    }
+#endif
+    while (i < num_words && words[i] == ~uint64_t(0)) {
+        ++i;
+    }
+    if (i == num_words) {
+        return static_cast<int>(num_words * 64);
+    }
+    return static_cast<int>(i * 64) + __builtin_ctzll(~words[i]);
+}
+
+// Colors taken by the neighbors of one vertex, packed 64 per word. One mask is reused
+// for every vertex of a run, so the search allocates only when the palette grows.
+class ForbiddenColorMask {
+public:
+    // Makes room for colors 0..num_colors, so the search can always return num_colors
+    void reserve(int num_colors) {
+        size_t num_words = static_cast<size_t>(num_colors) / 64 + 1;
+        if (num_words > words_.size()) {
+            words_.resize(num_words, 0);
+        }
+    }
+    void mark(int color) { words_[color >> 6] |= uint64_t(1) << (color & 63); }
+    int firstFree() const { return findFirstZeroBit(words_.data(), words_.size()); }
+    void clear() { std::fill(words_.begin(), words_.end(), 0); }
+
+private:
+    ScratchVector<uint64_t> words_;
+};
+
+// Smallest color not used by a colored neighbor of vertex, given that colors
+// 0..num_colors - 1 are in use (num_colors itself means a new color)
+template <typename GraphType>
+static int firstFreeColor(const GraphType& graph, int vertex, const std::vector<int>& colors, int num_colors,
+                          ForbiddenColorMask& forbidden) {
+    forbidden.reserve(num_colors);
+    for (int neighbor_id : graph.neighbors(vertex)) {
+        if (colors[neighbor_id] != -1) {
+            forbidden.mark(colors[neighbor_id]);
+        }
+    }
+    int color = forbidden.firstFree();
+    forbidden.clear();
+    return color;
+}
+
+// Random tie-break ranks of a randomized run: tie_ranks[v] for v in 1..n is a random
+// permutation of 0..n-1, and on a tie the vertex with the lower rank wins. Empty unless
+// options.randomize, in which case the engines keep their deterministic order.
+static ScratchVector<int> randomTieRanks(int num_vertices, const ColoringOptions& options) {
+    ScratchVector<int> tie_ranks;
+    if (!options.randomize) {
+        return tie_ranks;
+    }
+    tie_ranks.resize(num_vertices + 1, 0);
+    std::iota(tie_ranks.begin() + 1, tie_ranks.end(), 0);
+    GraphRandom random(options.seed);
+    for (int i = num_vertices; i > 1; --i) {
+        std::swap(tie_ranks[i], tie_ranks[1 + random.below(i)]);
+    }
+    return tie_ranks;
+}
+
+// True if a beats b on a tie: only in randomized runs, by the lower random rank
+static bool winsTie(const ScratchVector<int>& tie_ranks, int a, int b) {
+    return !tie_ranks.empty() && tie_ranks[a] < tie_ranks[b];
+}
+
+// Helper function to find the uncolored vertex with the largest degree
+// Returns the vertex ID, or 0 if no uncolored vertices remain.
+template <typename GraphType>
+static int find_max_degree_uncolored_vertex(const GraphType& graph, const std::vector<int>& colors,
+                                            const ScratchVector<int>& tie_ranks) {
+    int num_vertices = graph.numVertices();
+    int max_degree_vertex = 0;
+    int max_degree = -1;
+
+    TRACE_PHASE(PhaseSelection);
+    TRACE_OPS(PhaseSelection, num_vertices);
+    for (int i = 1; i <= num_vertices; ++i) {
+        if (colors[i] == -1) { // If uncolored
+            if (max_degree_vertex == 0 || graph.degree(i) > max_degree ||
+                (graph.degree(i) == max_degree && winsTie(tie_ranks, i, max_degree_vertex))) {
+                max_degree = graph.degree(i);
+                max_degree_vertex = i;
+            }
+        }
+    }
+    return max_degree_vertex;
+}
+
+// Selection keys of the greedy framework. Each key is maintained incrementally:
+// onColored() is the update rule, applied to the neighbors of a vertex as soon as it
+// gets a color, and operator() reads the current key of an uncolored vertex. A key that
+// tracks the colors around each vertex also answers firstFreeColor(); the others return -1.
+// GraphType is the GraphView the run was dispatched to.
+
+// Static degree
+template <typename GraphType>
+struct DegreeKey {
+    DegreeKey(const GraphType& graph, const ColoringOptions&, ColoringStats&) : graph_(graph) {}
+    void onColored(int, int, const std::vector<int>&) {}
+    int operator()(int v) const { return graph_.degree(v); }
+    int firstFreeColor(int, int) const { return -1; }
+
+    const GraphType& graph_;
+};
+
+// Number of colored neighbors (incidence degree)
+template <typename GraphType>
+struct IncidenceKey {
+    IncidenceKey(const GraphType& graph, const ColoringOptions&, ColoringStats&)
+        : graph_(graph), colored_neighbors_(graph.numVertices() + 1, 0) {}
+    void onColored(int vertex, int, const std::vector<int>&) {
+        for (int neighbor_id : graph_.neighbors(vertex)) {
+            colored_neighbors_[neighbor_id]++;
+        }
+    }
+    int operator()(int v) const { return colored_neighbors_[v]; }
+    int firstFreeColor(int, int) const { return -1; }
+
+    const GraphType& graph_;
+    ScratchVector<int> colored_neighbors_;
+};
+
+// Number of distinct colors among the neighbors (saturation degree). The colors around
+// each vertex are a bitset row of stride_ 64-bit words, widened as the palette grows, and
+// a vertex's counter goes up whenever one of its bits is newly set, so it always equals
+// the popcount of the row. Rows that would outgrow options.saturation_memory_limit are
+// converted to one std::set per vertex and the run continues with those.
+template <typename GraphType>
+struct SaturationKey {
+    SaturationKey(const GraphType& graph, const ColoringOptions& options, ColoringStats& stats)
+        : graph_(graph), num_rows_(graph.numVertices() + 1), memory_limit_(options.saturation_memory_limit),
+          stats_(stats), saturation_(graph.numVertices() + 1, 0) {
+        resizeRows(1);
+    }
+    void onColored(int vertex, int color, const std::vector<int>& colors) {
+        if (!use_sets_ && static_cast<size_t>(color) >= stride_ * 64) {
+            resizeRows(std::max(stride_ * 2, static_cast<size_t>(color) / 64 + 1));
+        }
+        if (use_sets_) {
+            for (int neighbor_id : graph_.neighbors(vertex)) {
+                if (colors[neighbor_id] == -1 && neighbor_colors_[neighbor_id].insert(color).second) {
+                    saturation_[neighbor_id]++;
+                }
+            }
+            return;
+        }
+        size_t word = static_cast<size_t>(color) >> 6;
+        uint64_t bit = uint64_t(1) << (color & 63);
+        for (int neighbor_id : graph_.neighbors(vertex)) {
+            if (colors[neighbor_id] == -1) {
+                uint64_t& row_word = rows_[neighbor_id * stride_ + word];
+                saturation_[neighbor_id] += (row_word & bit) == 0;
+                row_word |= bit;
+            }
+        }
+    }
+    int operator()(int v) const { return saturation_[v]; }
+    // Smallest color no colored neighbor of v uses (at most num_colors, a new color)
+    int firstFreeColor(int v, int) const {
+        if (use_sets_) {
+            int color = 0;
+            for (int used : neighbor_colors_[v]) {
+                if (used != color) {
+                    break;
+                }
+                color++;
+            }
+            return color;
+        }
+        return findFirstZeroBit(&rows_[v * stride_], stride_);
+    }
+
+    // Widens every row to new_stride words, or switches to sets above the memory limit
+    void resizeRows(size_t new_stride) {
+        size_t bytes = num_rows_ * new_stride * sizeof(uint64_t);
+        if (bytes > memory_limit_) {
+            neighbor_colors_.resize(num_rows_);
+            for (size_t v = 0; v < num_rows_ && stride_ > 0; ++v) {
+                for (size_t w = 0; w < stride_; ++w) {
+                    for (uint64_t bits = rows_[v * stride_ + w]; bits != 0; bits &= bits - 1) {
+                        neighbor_colors_[v].insert(static_cast<int>(w * 64) + __builtin_ctzll(bits));
+                    }
+                }
+            }
+            ScratchVector<uint64_t>().swap(rows_);
+            use_sets_ = true;
+            stats_.saturation_over_limit = true;
+            return;
+        }
+        ScratchVector<uint64_t> rows(num_rows_ * new_stride, 0);
+        for (size_t v = 0; v < num_rows_ && stride_ > 0; ++v) {
+            std::copy(rows_.begin() + v * stride_, rows_.begin() + (v + 1) * stride_, rows.begin() + v * new_stride);
+        }
+        rows_.swap(rows);
+        stride_ = new_stride;
+        stats_.saturation_bytes = std::max(stats_.saturation_bytes, bytes);
+    }
+
+    const GraphType& graph_;
+    size_t num_rows_;
+    size_t memory_limit_;
+    ColoringStats& stats_;
+    size_t stride_ = 0;                          // Words per row
+    ScratchVector<uint64_t> rows_;               // Row v at rows_[v * stride_], only kept up to date for uncolored vertices
+    bool use_sets_ = false;
+    std::vector<std::set<int>> neighbor_colors_; // Replaces rows_ above the memory limit
+    ScratchVector<int> saturation_;
+};
+
+// Degree in the subgraph induced by the uncolored vertices
+template <typename GraphType>
+struct UncoloredDegreeKey {
+    UncoloredDegreeKey(const GraphType& graph, const ColoringOptions&, ColoringStats&)
+        : graph_(graph), uncolored_degree_(graph.numVertices() + 1) {
+        for (int v = 1; v <= graph.numVertices(); ++v) {
+            uncolored_degree_[v] = graph.degree(v);
+        }
+    }
+    void onColored(int vertex, int, const std::vector<int>&) {
+        for (int neighbor_id : graph_.neighbors(vertex)) {
+            uncolored_degree_[neighbor_id]--;
+        }
+    }
+    int operator()(int v) const { return uncolored_degree_[v]; }
+    int firstFreeColor(int, int) const { return -1; }
+
+    const GraphType& graph_;
+    ScratchVector<int> uncolored_degree_;
+};
+
+// Heuristic policy of generic_greedy_coloring: the vertex with the largest Primary key
+// is colored next, ties are broken by the largest TieBreak key and then by the order of
+// the uncolored set (see IndexedVertexSet).
+template <typename Primary, typename TieBreak>
+struct GreedyHeuristic {
+    template <typename GraphType>
+    GreedyHeuristic(const GraphType& graph, const ColoringOptions& options, ColoringStats& stats)
+        : primary(graph, options, stats), tie_break(graph, options, stats) {}
+
+    void onColored(int vertex, int color, const std::vector<int>& colors) {
+        primary.onColored(vertex, color, colors);
+        tie_break.onColored(vertex, color, colors);
+    }
+
+    // Positive if a is a better choice than b, negative if b is better, 0 on a full tie
+    int compare(int a, int b) const {
+        int primary_difference = primary(a) - primary(b);
+        if (primary_difference != 0) {
+            return primary_difference;
+        }
+        return tie_break(a) - tie_break(b);
+    }
+
+    // Smallest free color of v from a key that tracks neighbor colors, or -1 if none does
+    int firstFreeColor(int v, int num_colors) const {
+        int color = primary.firstFreeColor(v, num_colors);
+        return color >= 0 ? color : tie_break.firstFreeColor(v, num_colors);
+    }
+
+    Primary primary;
+    TieBreak tie_break;
+};
+
+template <typename GraphType>
+using IDOHeuristic = GreedyHeuristic<IncidenceKey<GraphType>, DegreeKey<GraphType>>;
+template <typename GraphType>
+using DSATURHeuristic = GreedyHeuristic<SaturationKey<GraphType>, DegreeKey<GraphType>>;
+template <typename GraphType>
+using IDOSaturationHeuristic = GreedyHeuristic<IncidenceKey<GraphType>, SaturationKey<GraphType>>;
+template <typename GraphType>
+using DSATURUncoloredDegreeHeuristic = GreedyHeuristic<SaturationKey<GraphType>, UncoloredDegreeKey<GraphType>>;
+
+// Subset of the vertices (the uncolored ones of the greedy framework, the conflicting
+// ones of the local searches): an array plus the position of every vertex in it, so a
+// vertex is inserted or removed in O(1), removal moving the last element into its slot.
+// Iteration order is deterministic: it starts as the given order and changes only
+// through these operations. The greedy engines keep it in scratch memory
+// (ScratchIndexedVertexSet), the local searches, which share it between threads, on the heap.
+template <typename Allocator>
+class BasicIndexedVertexSet {
+public:
+    using Storage = std::vector<int, Allocator>;
+
+    explicit BasicIndexedVertexSet(int num_vertices) : positions_(num_vertices + 1, -1) {}
+    template <typename Order>
+    BasicIndexedVertexSet(const Order& order, int num_vertices)
+        : vertices_(order.begin(), order.end()), positions_(num_vertices + 1, -1) {
+        for (size_t i = 0; i < vertices_.size(); ++i) {
+            positions_[vertices_[i]] = static_cast<int>(i);
+        }
+    }
+
+    void insert(int vertex) {
+        positions_[vertex] = static_cast<int>(vertices_.size());
+        vertices_.push_back(vertex);
+    }
+
+    void remove(int vertex) {
+        int position = positions_[vertex];
+        int last = vertices_.back();
+        vertices_[position] = last;
+        positions_[last] = position;
+        vertices_.pop_back();
+        positions_[vertex] = -1;
+    }
+
+    void clear() {
+        for (int vertex : vertices_) {
+            positions_[vertex] = -1;
+        }
+        vertices_.clear();
+    }
+
+    bool contains(int vertex) const { return positions_[vertex] >= 0; }
+    bool empty() const { return vertices_.empty(); }
+    size_t size() const { return vertices_.size(); }
+    int operator[](size_t i) const { return vertices_[i]; }
+    typename Storage::const_iterator begin() const { return vertices_.begin(); }
+    typename Storage::const_iterator end() const { return vertices_.end(); }
+
+private:
+    Storage vertices_;
+    Storage positions_;
+};
+
+using IndexedVertexSet = BasicIndexedVertexSet<std::allocator<int>>;
+using ScratchIndexedVertexSet = BasicIndexedVertexSet<ScratchAllocator<int>>;
+
+// Common logic for greedy coloring algorithms (IDO, DSATUR and their variants).
+// The Heuristic policy decides which vertex is colored next; it is a template
+// parameter, so every algorithm is a separate instantiation without any dispatch
+// inside the loop. alg_name is only used in messages.
+// Full ties go to the first vertex in the IndexedVertexSet order or, with RankTieBreak,
+// to the vertex that came first in the initial degree order. The latter reproduces
+// the original implementation, which erased colored vertices from an ordered list,
+// and randomized runs shuffle equal degrees in that order.
+// Returns the total number of colors used
+template <typename Heuristic, bool RankTieBreak, typename GraphType>
+static int generic_greedy_coloring(const GraphType& graph, std::vector<int>& colors, const ColoringOptions& options,
+                                   ColoringStats& stats, const char* alg_name) {
+    int num_vertices = graph.numVertices();
+    int next_available_color_idx = 0; // Colors 0..next_available_color_idx - 1 are in use
+    ForbiddenColorMask forbidden_colors;
+
+    // Initialize all vertices to uncolored
+    colors.assign(num_vertices + 1, -1); // Ensure a clean state for coloring for this run
+    if (num_vertices == 0) {
+        return 0; // No vertices, no colors needed
+    }
+    Heuristic heuristic(graph, options, stats);
+
+    // Step 2 (for IDO/DSATUR): Select the uncolored vertex that has the largest degree.
+    // This initial sort applies to all the variants for the very first vertex.
+    ScratchVector<int> degree_order(num_vertices);
+    std::iota(degree_order.begin(), degree_order.end(), 1);
+    {
+        TRACE_PHASE(PhaseOrdering);
+        TRACE_OPS(PhaseOrdering, num_vertices);
+        ScratchVector<int> tie_ranks = randomTieRanks(num_vertices, options);
+        std::sort(degree_order.begin(), degree_order.end(),
+                  [&graph, &tie_ranks](int a, int b) {
+                      return graph.degree(a) > graph.degree(b) ||
+                             (graph.degree(a) == graph.degree(b) && winsTie(tie_ranks, a, b));
+                  });
+    }
+    ScratchVector<int> rank; // rank[v] = position of v in degree_order
+    if (RankTieBreak) {
+        rank.resize(num_vertices + 1);
+        for (int i = 0; i < num_vertices; ++i) {
+            rank[degree_order[i]] = i;
+        }
+    }
+    ScratchIndexedVertexSet uncolored_vertices(degree_order, num_vertices);
+
+    // Color the first selected vertex (highest degree) with the first color (0)
+    int initial_vertex = degree_order[0];
+    colors[initial_vertex] = next_available_color_idx;
+    next_available_color_idx++;
+    {
+        TRACE_PHASE(PhaseUpdate);
+        TRACE_OPS(PhaseUpdate, graph.neighbors(initial_vertex).size());
+        heuristic.onColored(initial_vertex, colors[initial_vertex], colors);
+    }
+
+    // Remove the colored vertex from the uncolored set
+    {
+        TRACE_PHASE(PhaseRemoval);
+        TRACE_OPS(PhaseRemoval, 1);
+        uncolored_vertices.remove(initial_vertex);
+    }
+
+
+    // Main coloring loop (Step 5: If uncolored vertex exists, return to step 3)
+    while (!uncolored_vertices.empty()) {
+        // Steps 3 and 4: find the best vertex for this iteration. The heuristic values
+        // of every uncolored vertex are kept current by the update rule below.
+        int best_vertex_for_this_iteration = 0;
+        {
+            TRACE_PHASE(PhaseSelection);
+            TRACE_OPS(PhaseSelection, uncolored_vertices.size());
+            for (int v : uncolored_vertices) {
+                if (best_vertex_for_this_iteration == 0) {
+                    best_vertex_for_this_iteration = v;
+                    continue;
+                }
+                int comparison = heuristic.compare(v, best_vertex_for_this_iteration);
+                if (comparison > 0 || (RankTieBreak && comparison == 0 && rank[v] < rank[best_vertex_for_this_iteration])) {
+                    best_vertex_for_this_iteration = v;
+                }
+            }
+        }
+
+        if (best_vertex_for_this_iteration == 0) {
+            std::cerr << "Warning [" << alg_name << "]: No best vertex found while uncolored_vertices is not empty. Breaking loop." << std::endl;
+            break;
+        }
+
+        // Step 4: Color the selected vertex with the smallest existing color its
+        // neighbors leave free, or with a new color. Saturation keys already know the
+        // colors around the vertex; otherwise they are collected from the neighbors.
+        int chosen_color;
+        {
+            TRACE_PHASE(PhaseColorSearch);
+            chosen_color = heuristic.firstFreeColor(best_vertex_for_this_iteration, next_available_color_idx);
+            if (chosen_color < 0) {
+                TRACE_OPS(PhaseColorSearch, graph.neighbors(best_vertex_for_this_iteration).size());
+                chosen_color = firstFreeColor(graph, best_vertex_for_this_iteration, colors, next_available_color_idx,
+                                              forbidden_colors);
+            } else {
+                TRACE_OPS(PhaseColorSearch, 1);
+            }
+        }
+
+        if (chosen_color == next_available_color_idx) {
+            next_available_color_idx++;
+        }
+
+        colors[best_vertex_for_this_iteration] = chosen_color;
+
+        // Update rule: adjust the heuristic values of the neighbors
+        {
+            TRACE_PHASE(PhaseUpdate);
+            TRACE_OPS(PhaseUpdate, graph.neighbors(best_vertex_for_this_iteration).size());
+            heuristic.onColored(best_vertex_for_this_iteration, chosen_color, colors);
+        }
+
+        // Remove the colored vertex from the uncolored set
+        TRACE_PHASE(PhaseRemoval);
+        TRACE_OPS(PhaseRemoval, 1);
+        uncolored_vertices.remove(best_vertex_for_this_iteration);
+    }
+
+    return next_available_color_idx; // Return the total number of colors used
+}
+
+// Runs generic_greedy_coloring with Heuristic<GraphView<Id>> for the ID width of graph
+template <template <typename> class Heuristic>
+static int run_greedy_coloring(const Graph& graph, std::vector<int>& colors, const ColoringOptions& options,
+                               ColoringStats* stats, const char* alg_name) {
+    ScratchScope scratch; // Temporary arrays of the run, given back when it returns
+    ColoringStats local_stats;
+    ColoringStats& run_stats = stats ? *stats : local_stats;
+    run_stats = ColoringStats();
+    return graph.visit([&](const auto& view) {
+        using View = std::decay_t<decltype(view)>;
+        return options.legacy_tie_break || options.randomize
+                   ? generic_greedy_coloring<Heuristic<View>, true>(view, colors, options, run_stats, alg_name)
+                   : generic_greedy_coloring<Heuristic<View>, false>(view, colors, options, run_stats, alg_name);
+    });
+}
+
+// Wrapper for IDO
+int IDO_coloring(const Graph& graph, std::vector<int>& colors, const ColoringOptions& options, ColoringStats* stats) {
+    return run_greedy_coloring<IDOHeuristic>(graph, colors, options, stats, "IDO");
+}
+
+// Wrapper for DSATUR
+int DSATUR_coloring(const Graph& graph, std::vector<int>& colors, const ColoringOptions& options, ColoringStats* stats) {
+    return run_greedy_coloring<DSATURHeuristic>(graph, colors, options, stats, "DSATUR");
+}
+
+// IDO with ties broken by saturation degree instead of degree
+int IDOSaturation_coloring(const Graph& graph, std::vector<int>& colors, const ColoringOptions& options,
+                           ColoringStats* stats) {
+    return run_greedy_coloring<IDOSaturationHeuristic>(graph, colors, options, stats, "IDO-SAT");
+}
+
+// DSATUR with Brelaz's tie-break: largest degree in the uncolored subgraph
+int DSATURUncoloredDegree_coloring(const Graph& graph, std::vector<int>& colors, const ColoringOptions& options,
+                                   ColoringStats* stats) {
+    return run_greedy_coloring<DSATURUncoloredDegreeHeuristic>(graph, colors, options, stats, "DSATUR-UD");
+}
+
+// Implementation of the Recursive Largest First Algorithm (RLF)
+template <typename GraphType>
+static int rlf_coloring(const GraphType& graph, std::vector<int>& colors, const ColoringOptions& options) {
+    ScratchScope scratch; // Temporary arrays of the run, given back when it returns
+    int num_vertices = graph.numVertices();
+    int current_color = 0;
+    int total_colored_vertices = 0;
+
+    // Reset all vertex colors at the start of RLF run
+    colors.assign(num_vertices + 1, -1);
+    // Count of neighbors in the 'U' set (forbidden for current color) of the candidates
+    ScratchVector<int> heuristic(num_vertices + 1, 0);
+    ScratchVector<int> tie_ranks = randomTieRanks(num_vertices, options);
+    // U set: Neighbors of the current color class members (cannot take active color)
+    // V_prime: Uncolored vertices NOT adjacent to any in the current color class (can potentially take active color)
+    ScratchVector<bool> forbidden_for_current_color(num_vertices + 1, false);
+
+    // Outer loop: Iterate through colors until all vertices are colored
+    while (total_colored_vertices < num_vertices) {
+        // Step 1: Select the uncolored vertex which has the largest degree.
+        int v_i = find_max_degree_uncolored_vertex(graph, colors, tie_ranks);
+
+        if (v_i == 0) { // Should not happen if total_colored_vertices < num_vertices
+            std::cerr << "Warning [RLF]: No uncolored vertex found unexpectedly. Breaking loop." << std::endl;
+            break;
+        }
+
+        // Step 2: The selected vertex is colored with active color.
+        colors[v_i] = current_color;
+        total_colored_vertices++;
+        
+        // Initialize forbidden set U with neighbors of v_i
+        std::fill(forbidden_for_current_color.begin(), forbidden_for_current_color.end(), false);
+        for (int neighbor_id : graph.neighbors(v_i)) {
+            forbidden_for_current_color[neighbor_id] = true;
+        }
+
+        // Inner loop: Recursively select uncolored vertices for the current color class
+        while (true) {
+            int v_j_candidate = 0; // The next vertex to add to current color class
+            int max_adj_in_U = -1;
+
+            // Iterate through all vertices to find candidates for V' and calculate heuristic
+            {
+                TRACE_PHASE(PhaseHeuristic);
+                for (int k = 1; k <= num_vertices; ++k) {
+                    if (colors[k] == -1 && !forbidden_for_current_color[k]) { // Is uncolored AND not forbidden (in V')
+                        TRACE_OPS(PhaseHeuristic, graph.neighbors(k).size());
+                        // Calculate number of adjacent vertices which are in the set of U for every vertex in set of V'
+                        int current_adj_in_U = 0;
+                        for (int neighbor_of_vk : graph.neighbors(k)) {
+                            if (forbidden_for_current_color[neighbor_of_vk]) { // If neighbor is in U (forbidden set)
+                                current_adj_in_U++;
+                            }
+                        }
+                        heuristic[k] = current_adj_in_U; // Store for selection
+                    }
+                }
+            }
+
+            {
+                TRACE_PHASE(PhaseSelection);
+                TRACE_OPS(PhaseSelection, num_vertices);
+                for (int k = 1; k <= num_vertices; ++k) {
+                    if (colors[k] == -1 && !forbidden_for_current_color[k]) { // Candidates of V' only
+                        // Select the uncolored vertex whose has maximum adjacent vertices (which are in the set of U) in the set of V'
+                        // If more than one vertex provide this condition, the vertex which has the largest degree among them is selected.
+                        if (v_j_candidate == 0 ||
+                            heuristic[k] > max_adj_in_U ||
+                            (heuristic[k] == max_adj_in_U && graph.degree(k) > graph.degree(v_j_candidate)) ||
+                            (heuristic[k] == max_adj_in_U && graph.degree(k) == graph.degree(v_j_candidate) &&
+                             winsTie(tie_ranks, k, v_j_candidate))) {
+
+                            max_adj_in_U = heuristic[k];
+                            v_j_candidate = k;
+                        }
+                    }
+                }
+            }
+
+            if (v_j_candidate == 0) {
+                // Set V' is empty or no more eligible vertices for this color
+                break; // Move to Step 3 (next color)
+            }
+
+            // The selected vertex is colored with active color.
+            colors[v_j_candidate] = current_color;
+            total_colored_vertices++;
+
+            // Update forbidden set U: Add adjacent vertices of the colored vertex to U
+            TRACE_PHASE(PhaseUpdate);
+            TRACE_OPS(PhaseUpdate, graph.neighbors(v_j_candidate).size());
+            for (int neighbor_id : graph.neighbors(v_j_candidate)) {
+                forbidden_for_current_color[neighbor_id] = true;
+            }
+            // The colored vertex and its neighbors (which are now in U) are implicitly handled.
+            // No explicit deletion from V' is needed if we re-evaluate V' candidates in each iteration.
+        }
+        
+        // Step 3: If uncolored vertex exists, next color in the color set is selected as active.
+        current_color++; // Prepare for the next color class
+    }
+
+    // After loop, current_color holds the total number of colors used (since it increments one last time).
+    return current_color; 
+}
+
+int RLF_coloring(const Graph& graph, std::vector<int>& colors, const ColoringOptions& options) {
+    return graph.visit([&](const auto& view) { return rlf_coloring(view, colors, options); });
+}
+
+// Implementation of the First Fit Graph Coloring Algorithm
+template <typename GraphType>
+static int first_fit_coloring(const GraphType& graph, std::vector<int>& colors, const ColoringOptions& options) {
+    ScratchScope scratch; // Temporary arrays of the run, given back when it returns
+    // Reset all vertex colors at the start of First Fit run
+    int num_vertices = graph.numVertices();
+    colors.assign(num_vertices + 1, -1);
+
+    // Assign the first color to the first vertex (color 0)
+    if (num_vertices == 0) {
+        return 0;
+    }
+    // Vertex order: 1..n, or the random rank order of a randomized run (no ties to break)
+    ScratchVector<int> order(num_vertices);
+    std::iota(order.begin(), order.end(), 1);
+    ScratchVector<int> tie_ranks = randomTieRanks(num_vertices, options);
+    if (!tie_ranks.empty()) {
+        for (int v = 1; v <= num_vertices; ++v) {
+            order[tie_ranks[v]] = v;
+        }
+    }
+    colors[order[0]] = 0;
+    int max_color_used = 0;
+    ForbiddenColorMask forbidden_colors; // Colors of the neighbors of the current vertex
+
+    // Iterate through the remaining vertices
+    for (int i = 1; i < num_vertices; ++i) {
+        int u = order[i];
+        TRACE_PHASE(PhaseColorSearch);
+        TRACE_OPS(PhaseColorSearch, graph.neighbors(u).size());
+        // Find the smallest color not used by a colored neighbor
+        int color = firstFreeColor(graph, u, colors, max_color_used + 1, forbidden_colors);
+
+        colors[u] = color; // Assign the found color to vertex u
+        
+        // Update max color used
+        if (color > max_color_used) {
+            max_color_used = color;
+        }
+    }
+
+    return max_color_used + 1; // Return the total number of colors used (colors are 0-indexed)
+}
+
+int FirstFit_coloring(const Graph& graph, std::vector<int>& colors, const ColoringOptions& options) {
+    return graph.visit([&](const auto& view) { return first_fit_coloring(view, colors, options); });
+}
+
+// Implementation of the Welsh-Powell Graph Coloring Algorithm
+template <typename GraphType>
+static int welsh_powell_coloring(const GraphType& graph, std::vector<int>& colors, const ColoringOptions& options) {
+    ScratchScope scratch; // Temporary arrays of the run, given back when it returns
+    // Reset all vertex colors at the start of Welsh-Powell run
+    int num_vertices = graph.numVertices();
+    colors.assign(num_vertices + 1, -1);
+    ScratchVector<int> tie_ranks = randomTieRanks(num_vertices, options);
+
+    ScratchVector<bool> colored(num_vertices + 1, false); // To control which vertices have been colored
+    int current_color = 0;
+    // Per color: the vertices that receive it, and the uncolored vertices by degree.
+    // Cleared for every color, so their storage is allocated once.
+    ScratchVector<int> current_group;
+    ScratchVector<std::pair<int, int>> vertex_degree_pairs; // (vertex_id, degree)
+    current_group.reserve(num_vertices);
+    vertex_degree_pairs.reserve(num_vertices);
+
+    while (true) {
+        bool all_colored = true;
+        current_group.clear();
+
+        // Find the first uncolored vertex with the highest degree
+        int start_vertex = -1;
+        int max_degree = -1;
+
+        {
+            TRACE_PHASE(PhaseSelection);
+            TRACE_OPS(PhaseSelection, num_vertices);
+            for (int i = 1; i <= num_vertices; ++i) {
+                if (!colored[i] && (graph.degree(i) > max_degree ||
+                                    (graph.degree(i) == max_degree && winsTie(tie_ranks, i, start_vertex)))) {
+                    start_vertex = i;
+                    max_degree = graph.degree(i);
+                    all_colored = false;
+                }
+            }
+        }
+
+        if (all_colored) {
+            break; // All vertices have been colored
+        }
+
+        // Assign current_color to start_vertex and add it to the group
+        colors[start_vertex] = current_color;
+        colored[start_vertex] = true;
+        current_group.push_back(start_vertex);
+
+        // Go through uncolored vertices (in order of degree)
+        // Create a list of vertices sorted by degree for this iteration
+        vertex_degree_pairs.clear();
+        for (int i = 1; i <= num_vertices; ++i) {
+            if (!colored[i]) {
+                vertex_degree_pairs.push_back({i, graph.degree(i)});
+            }
+        }
+        
+        // Sort by degree in descending order
+        {
+            TRACE_PHASE(PhaseOrdering);
+            TRACE_OPS(PhaseOrdering, vertex_degree_pairs.size());
+            std::sort(vertex_degree_pairs.begin(), vertex_degree_pairs.end(),
+                      [&tie_ranks](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+                          return a.second > b.second ||
+                                 (a.second == b.second && winsTie(tie_ranks, a.first, b.first));
+                      });
+        }
+
+        // Check each uncolored vertex
+        TRACE_PHASE(PhaseColorSearch);
+        for (const auto& vd_candidate : vertex_degree_pairs) {
+            int candidate_vertex = vd_candidate.first;
+            if (!colored[candidate_vertex]) {
+                bool can_assign_color = true;
+                
+                // Check if candidate_vertex is adjacent to any vertex in current_group
+                TRACE_OPS(PhaseColorSearch, current_group.size());
+                for (int colored_vertex_in_group : current_group) {
+                    // Check if candidate_vertex is adjacent to colored_vertex_in_group
+                    bool is_adjacent = false;
+                    for (int neighbor_id : graph.neighbors(candidate_vertex)) {
+                        if (neighbor_id == colored_vertex_in_group) {
+                            is_adjacent = true;
+                            break;
+                        }
+                    }
+                    if (is_adjacent) {
+                        can_assign_color = false;
+                        break;
+                    }
+                }
+                
+                if (can_assign_color) {
+                    // If not adjacent, assign the same color and add to group
+                    colors[candidate_vertex] = current_color;
+                    colored[candidate_vertex] = true;
+                    current_group.push_back(candidate_vertex);
+                }
+            }
+        }
+        current_color++; // Move to the next color
+    }
+
+    return current_color; // Return the total number of colors used
+}
+
+int WelshPowell_coloring(const Graph& graph, std::vector<int>& colors, const ColoringOptions& options) {
+    return graph.visit([&](const auto& view) { return welsh_powell_coloring(view, colors, options); });
+}
+
+// Implementation of the Largest Degree Ordering (LDO) Graph Coloring Algorithm
+template <typename GraphType>
+static int largest_degree_ordering_coloring(const GraphType& graph, std::vector<int>& colors, const ColoringOptions& options) {
+    ScratchScope scratch; // Temporary arrays of the run, given back when it returns
+    // Reset all vertex colors at the start of LDO run
+    int num_vertices = graph.numVertices();
+    colors.assign(num_vertices + 1, -1);
+
+    // Create a list of vertices sorted by degree in descending order
+    ScratchVector<std::pair<int, int>> vertex_degree_pairs; // (vertex_id, degree)
+    vertex_degree_pairs.reserve(num_vertices);
+    for (int i = 1; i <= num_vertices; ++i) {
+        vertex_degree_pairs.push_back({i, graph.degree(i)});
+    }
+    
+    // Sort by degree in descending order
+    {
+        TRACE_PHASE(PhaseOrdering);
+        TRACE_OPS(PhaseOrdering, vertex_degree_pairs.size());
+        ScratchVector<int> tie_ranks = randomTieRanks(num_vertices, options);
+        std::sort(vertex_degree_pairs.begin(), vertex_degree_pairs.end(),
+                  [&tie_ranks](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+                      return a.second > b.second ||
+                             (a.second == b.second && winsTie(tie_ranks, a.first, b.first));
+                  });
+    }
+
+    int max_color_used = -1;
+    ForbiddenColorMask forbidden_colors; // Colors of the neighbors of the current vertex
+
+    // Color vertices in the order determined by degree
+    for (const auto& vd : vertex_degree_pairs) {
+        int u = vd.first; // The vertex to be colored
+        TRACE_PHASE(PhaseColorSearch);
+        TRACE_OPS(PhaseColorSearch, graph.neighbors(u).size());
+
+        // Find the smallest color not used by one of u's colored neighbors
+        int color = firstFreeColor(graph, u, colors, max_color_used + 1, forbidden_colors);
+
+        colors[u] = color; // Assign the found color to vertex u
+        
+        // Update max color used
+        if (color > max_color_used) {
+            max_color_used = color;
+        }
+    }
+
+    return max_color_used + 1; // Return the total number of colors used (colors are 0-indexed)
+}
+
+int LargestDegreeOrdering_coloring(const Graph& graph, std::vector<int>& colors, const ColoringOptions& options) {
+    return graph.visit([&](const auto& view) { return largest_degree_ordering_coloring(view, colors, options); });
+}
+
+std::string algorithmName(Algorithm algorithm) {
+    switch (algorithm) {
+        case Algorithm::FirstFit: return "FF";
+        case Algorithm::WelshPowell: return "WP";
+        case Algorithm::LargestDegreeOrdering: return "LDO";
+        case Algorithm::IncidenceDegreeOrdering: return "IDO";
+        case Algorithm::DSATUR: return "DSATUR";
+        case Algorithm::RLF: return "RLF";
+        case Algorithm::IncidenceDegreeSaturation: return "IDO-SAT";
+        default: return "DSATUR-UD";
+    }
+}
+
+bool parseAlgorithm(const std::string& name, Algorithm& algorithm) {
+    std::vector<Algorithm> candidates = allAlgorithms();
+    candidates.push_back(Algorithm::IncidenceDegreeSaturation);
+    candidates.push_back(Algorithm::DSATURUncoloredDegree);
+    for (Algorithm candidate : candidates) {
+        if (algorithmName(candidate) == name) {
+            algorithm = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<Algorithm> allAlgorithms() {
+    return {Algorithm::FirstFit, Algorithm::WelshPowell, Algorithm::LargestDegreeOrdering,
+            Algorithm::IncidenceDegreeOrdering, Algorithm::DSATUR, Algorithm::RLF};
+}
+
+ColoringResult colorGraph(const Graph& graph, Algorithm algorithm, const ColoringOptions& options) {
+    ColoringResult result;
+    colorGraph(graph, algorithm, options, result);
+    return result;
+}
+
+void colorGraph(const Graph& graph, Algorithm algorithm, const ColoringOptions& options, ColoringResult& result) {
+    result.algorithm = algorithm;
+    result.stats = ColoringStats();
+    auto start_time = std::chrono::steady_clock::now();
+    switch (algorithm) {
+        case Algorithm::FirstFit:
+            result.colors_used = FirstFit_coloring(graph, result.colors, options);
+            break;
+        case Algorithm::WelshPowell:
+            result.colors_used = WelshPowell_coloring(graph, result.colors, options);
+            break;
+        case Algorithm::LargestDegreeOrdering:
+            result.colors_used = LargestDegreeOrdering_coloring(graph, result.colors, options);
+            break;
+        case Algorithm::IncidenceDegreeOrdering:
+            result.colors_used = IDO_coloring(graph, result.colors, options, &result.stats);
+            break;
+        case Algorithm::DSATUR:
+            result.colors_used = DSATUR_coloring(graph, result.colors, options, &result.stats);
+            break;
+        case Algorithm::RLF:
+            result.colors_used = RLF_coloring(graph, result.colors, options);
+            break;
+        case Algorithm::IncidenceDegreeSaturation:
+            result.colors_used = IDOSaturation_coloring(graph, result.colors, options, &result.stats);
+            break;
+        case Algorithm::DSATURUncoloredDegree:
+            result.colors_used = DSATURUncoloredDegree_coloring(graph, result.colors, options, &result.stats);
+            break;
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start_time;
+    result.elapsed_ms = elapsed.count();
+}
+
+MultiStartResult runMultiStart(const Graph& graph, Algorithm algorithm, const ColoringOptions& options,
+                               const MultiStartOptions& multi_start) {
+    MultiStartResult result;
+    int num_seeds = std::max(1, multi_start.num_seeds);
+    int num_threads = multi_start.num_threads > 0 ? multi_start.num_threads
+                                                  : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    num_threads = std::min(num_threads, num_seeds);
+    result.colors_per_seed.assign(num_seeds, 0);
+    result.num_threads = num_threads;
+
+    // Seeds are handed out one at a time; every thread keeps its own best coloring
+    std::atomic<int> next_seed_index(0);
+    std::vector<ColoringResult> thread_best(num_threads);
+    std::vector<int> thread_best_index(num_threads, -1);
+    auto start_time = std::chrono::steady_clock::now();
+    runOnThreads(num_threads, [&](int t) {
+        ColoringOptions run_options = options;
+        run_options.randomize = true;
+        for (int i = next_seed_index++; i < num_seeds; i = next_seed_index++) {
+            run_options.seed = multi_start.first_seed + i;
+            ColoringResult run = colorGraph(graph, algorithm, run_options);
+            result.colors_per_seed[i] = run.colors_used;
+            if (thread_best_index[t] < 0 || run.colors_used < thread_best[t].colors_used ||
+                (run.colors_used == thread_best[t].colors_used && i < thread_best_index[t])) {
+                thread_best[t] = std::move(run);
+                thread_best_index[t] = i;
+            }
+        }
+    });
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start_time;
+
+    // Fewest colors wins, the lowest seed among equals, whatever thread ran it
+    int best_thread = -1;
+    for (int t = 0; t < num_threads; ++t) {
+        if (thread_best_index[t] >= 0 &&
+            (best_thread < 0 || thread_best[t].colors_used < thread_best[best_thread].colors_used ||
+             (thread_best[t].colors_used == thread_best[best_thread].colors_used &&
+              thread_best_index[t] < thread_best_index[best_thread]))) {
+            best_thread = t;
+        }
+    }
+    result.best = std::move(thread_best[best_thread]);
+    result.best_seed = multi_start.first_seed + thread_best_index[best_thread];
+    result.elapsed_ms = elapsed.count();
+    result.colorings_per_second = result.elapsed_ms > 0.0 ? num_seeds * 1000.0 / result.elapsed_ms : 0.0;
+    result.colorings_per_second_per_core = result.colorings_per_second / num_threads;
+    return result;
+}
+
+long long countColoringConflicts(const Graph& graph, const std::vector<int>& colors) {
+    return graph.visit([&colors](const auto& view) {
+        long long conflicts = 0;
+        for (int u = 1; u <= view.numVertices(); ++u) {
+            for (int v : view.neighbors(u)) {
+                if (u < v && colors[u] == colors[v]) {
+                    conflicts++;
+                }
+            }
+        }
+        return conflicts;
+    });
+}
+
+bool parseClassOrder(const std::string& name, ClassOrder& order) {
+    if (name == "reverse") {
+        order = ClassOrder::Reverse;
+    } else if (name == "largest") {
+        order = ClassOrder::LargestFirst;
+    } else if (name == "random") {
+        order = ClassOrder::Random;
+    } else if (name == "degree-sum") {
+        order = ClassOrder::DegreeSum;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string classOrderName(ClassOrder order) {
+    switch (order) {
+        case ClassOrder::Reverse: return "reverse";
+        case ClassOrder::LargestFirst: return "largest";
+        case ClassOrder::Random: return "random";
+        default: return "degree-sum";
+    }
+}
+
+// Order in which the color classes 0..num_colors - 1 are visited by the next pass
+static std::vector<int> orderColorClasses(const Graph& graph, const std::vector<int>& colors, int num_colors,
+                                          ClassOrder order, GraphRandom& random) {
+    std::vector<int> class_order(num_colors);
+    std::iota(class_order.begin(), class_order.end(), 0);
+    if (order == ClassOrder::Reverse) {
+        std::reverse(class_order.begin(), class_order.end());
+    } else if (order == ClassOrder::Random) {
+        for (int i = num_colors - 1; i > 0; --i) {
+            std::swap(class_order[i], class_order[random.below(i + 1)]);
+        }
+    } else {
+        // Largest classes (by vertex count or by degree sum) first, lower color among equals
+        std::vector<long long> weight(num_colors, 0);
+        for (int v = 1; v <= graph.numVertices(); ++v) {
+            if (colors[v] < 0) {
+                continue;
+            }
+            weight[colors[v]] += order == ClassOrder::LargestFirst ? 1 : graph.degree(v);
+        }
+        std::stable_sort(class_order.begin(), class_order.end(),
+                         [&weight](int a, int b) { return weight[a] > weight[b]; });
+    }
+    return class_order;
+}
+
+IteratedGreedyResult iteratedGreedy(const Graph& graph, const ColoringResult& initial, const IteratedGreedyOptions& options) {
+    ScratchScope scratch; // For the forbidden color mask
+    int num_vertices = graph.numVertices();
+    IteratedGreedyResult result;
+    result.coloring = initial;
+    result.initial_colors = initial.colors_used;
+    std::vector<ClassOrder> orders = options.orders;
+    if (orders.empty() || num_vertices == 0) {
+        return result;
+    }
+    for (int v = 1; v <= num_vertices; ++v) {
+        if (initial.colors[v] >= initial.colors_used) {
+            return result; // Not a coloring with colors_used colors: returned unchanged
+        }
+    }
+
+    GraphRandom random(options.seed);
+    ForbiddenColorMask forbidden_colors;
+    std::vector<int> class_start(initial.colors_used + 1);
+    std::vector<int> class_members(num_vertices);
+    std::vector<int> new_colors;
+    auto start_time = std::chrono::steady_clock::now();
+    auto elapsed_ms = [&start_time]() {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+    };
+
+    while (options.max_iterations <= 0 || result.iterations < options.max_iterations) {
+        if (options.max_iterations <= 0 && elapsed_ms() >= options.time_budget_ms) {
+            break;
+        }
+        std::vector<int>& colors = result.coloring.colors;
+        int num_colors = result.coloring.colors_used;
+
+        // Bucket the vertices by color (counting sort, vertex order kept within a class);
+        // uncolored vertices follow the last class
+        class_start.assign(num_colors + 1, 0);
+        for (int v = 1; v <= num_vertices; ++v) {
+            if (colors[v] >= 0) {
+                class_start[colors[v] + 1]++;
+            }
+        }
+        for (int c = 0; c < num_colors; ++c) {
+            class_start[c + 1] += class_start[c];
+        }
+        {
+            std::vector<int> fill = class_start;
+            int uncolored = class_start[num_colors];
+            for (int v = 1; v <= num_vertices; ++v) {
+                class_members[colors[v] >= 0 ? fill[colors[v]]++ : uncolored++] = v;
+            }
+        }
+
+        // One greedy pass over the classes in the new order. Each class stays an
+        // independent set, so it never needs more colors than before.
+        ClassOrder order = orders[orders.size() == 1 ? 0 : random.below(static_cast<int>(orders.size()))];
+        new_colors.assign(num_vertices + 1, -1);
+        int new_num_colors = 0;
+        std::vector<int> class_order = orderColorClasses(graph, colors, num_colors, order, random);
+        graph.visit([&](const auto& view) {
+            auto color_members = [&](int begin, int end) {
+                for (int i = begin; i < end; ++i) {
+                    int v = class_members[i];
+                    int color = firstFreeColor(view, v, new_colors, new_num_colors, forbidden_colors);
+                    new_colors[v] = color;
+                    new_num_colors = std::max(new_num_colors, color + 1);
+                }
+            };
+            for (int c : class_order) {
+                color_members(class_start[c], class_start[c + 1]);
+            }
+            color_members(class_start[num_colors], num_vertices); // Uncolored, first pass only
+        });
+        colors.swap(new_colors);
+        result.coloring.colors_used = new_num_colors;
+        result.iterations++;
+        if (new_num_colors < num_colors) {
+            result.improvements.push_back({result.iterations, elapsed_ms(), new_num_colors, order});
+        }
+    }
+
+    result.elapsed_ms = elapsed_ms();
+    result.coloring.elapsed_ms = initial.elapsed_ms + result.elapsed_ms;
+    result.iterations_per_second = result.elapsed_ms > 0.0 ? result.iterations * 1000.0 / result.elapsed_ms : 0.0;
+    return result;
+}
+
+// Tabu search for a legal coloring with a fixed number of colors k (TabuCol by Hertz and
+// de Werra, with the dynamic tenure of Galinier and Hao). A move recolors a conflicting
+// vertex; conflict_table_[v * k + c] counts the neighbors of v that have color c, so every
+// move is evaluated in O(1) and applied in O(deg(v)). The buffers are reused across runs.
+class TabuCol {
+public:
+    explicit TabuCol(const Graph& graph) : graph_(graph), conflicting_(graph.numVertices()) {}
+
+    // Bytes of the tables for k colors. Allocating them once for the largest k that will be
+    // searched lets every later run, with k or fewer colors, reuse them.
+    static size_t tableBytes(int num_vertices, int num_colors) {
+        return (static_cast<size_t>(num_vertices) + 1) * static_cast<size_t>(num_colors) * (sizeof(int) + sizeof(long long));
+    }
+    void reserveTables(int num_colors) {
+        size_t entries = (static_cast<size_t>(graph_.numVertices()) + 1) * static_cast<size_t>(num_colors);
+        conflict_table_.reserve(entries);
+        tabu_until_.reserve(entries);
+        best_colors_.reserve(graph_.numVertices() + 1);
+    }
+    size_t reservedBytes() const {
+        return conflict_table_.capacity() * sizeof(int) + tabu_until_.capacity() * sizeof(long long);
+    }
+
+    // Improves colors (values in 0..num_colors - 1) for at most max_iterations moves or
+    // until the deadline, and leaves the best coloring seen in it. Returns its number of
+    // conflicting edges (0 for a legal coloring).
+    long long run(std::vector<int>& colors, int num_colors, long long max_iterations,
+                  std::chrono::steady_clock::time_point deadline, GraphRandom& random) {
+        return graph_.visit([&](const auto& view) {
+            return search(view, colors, num_colors, max_iterations, deadline, random);
+        });
+    }
+
+private:
+    template <typename GraphType>
+    long long search(const GraphType& graph, std::vector<int>& colors, int num_colors, long long max_iterations,
+                     std::chrono::steady_clock::time_point deadline, GraphRandom& random) {
+        int num_vertices = graph.numVertices();
+        size_t k = static_cast<size_t>(num_colors);
+        conflict_table_.assign((num_vertices + 1) * k, 0);
+        tabu_until_.assign((num_vertices + 1) * k, 0);
+        conflicting_.clear();
+        long long conflicts = 0;
+        for (int v = 1; v <= num_vertices; ++v) {
+            for (int neighbor_id : graph.neighbors(v)) {
+                conflict_table_[v * k + colors[neighbor_id]]++;
+            }
+        }
+        for (int v = 1; v <= num_vertices; ++v) {
+            if (conflict_table_[v * k + colors[v]] > 0) {
+                conflicting_.insert(v);
+                conflicts += conflict_table_[v * k + colors[v]];
+            }
+        }
+        conflicts /= 2;
+        long long best_conflicts = conflicts;
+        best_colors_ = colors;
+
+        for (long long iteration = 0; iteration < max_iterations && conflicts > 0; ++iteration) {
+            if ((iteration & 255) == 0 && std::chrono::steady_clock::now() >= deadline) {
+                break;
+            }
+            // Best non-tabu move, or a tabu one that beats the best coloring (aspiration);
+            // ties are broken uniformly at random
+            int move_vertex = 0;
+            int move_color = -1;
+            int best_delta = 0;
+            int ties = 0;
+            for (size_t i = 0; i < conflicting_.size(); ++i) {
+                int v = conflicting_[i];
+                const int* row = &conflict_table_[v * k];
+                const long long* tabu_row = &tabu_until_[v * k];
+                int current = row[colors[v]];
+                for (int c = 0; c < num_colors; ++c) {
+                    if (c == colors[v]) {
+                        continue;
+                    }
+                    int delta = row[c] - current;
+                    if (tabu_row[c] > iteration && conflicts + delta >= best_conflicts) {
+                        continue;
+                    }
+                    if (move_vertex == 0 || delta < best_delta) {
+                        move_vertex = v;
+                        move_color = c;
+                        best_delta = delta;
+                        ties = 1;
+                    } else if (delta == best_delta && random.below(++ties) == 0) {
+                        move_vertex = v;
+                        move_color = c;
+                    }
+                }
+            }
+            if (move_vertex == 0) {
+                continue; // Every move is tabu
+            }
+
+            int old_color = colors[move_vertex];
+            colors[move_vertex] = move_color;
+            for (int neighbor_id : graph.neighbors(move_vertex)) {
+                int* row = &conflict_table_[neighbor_id * k];
+                row[old_color]--;
+                row[move_color]++;
+                if (colors[neighbor_id] == old_color && row[old_color] == 0) {
+                    conflicting_.remove(neighbor_id);
+                } else if (colors[neighbor_id] == move_color && row[move_color] == 1) {
+                    conflicting_.insert(neighbor_id);
+                }
+            }
+            if (conflict_table_[move_vertex * k + move_color] == 0) {
+                conflicting_.remove(move_vertex);
+            }
+            conflicts += best_delta;
+            tabu_until_[move_vertex * k + old_color] =
+                iteration + random.below(10) + static_cast<long long>(0.6 * conflicting_.size());
+            if (conflicts < best_conflicts) {
+                best_conflicts = conflicts;
+                best_colors_ = colors;
+            }
+        }
+        colors.swap(best_colors_);
+        return best_conflicts;
+    }
+
+    const Graph& graph_;
+    std::vector<int> conflict_table_;
+    std::vector<long long> tabu_until_;
+    IndexedVertexSet conflicting_;
+    std::vector<int> best_colors_;
+};
+
+// Recolors the vertices with a color of num_colors or more at random below num_colors
+static void restrictColors(std::vector<int>& colors, int num_colors, GraphRandom& random) {
+    for (size_t v = 1; v < colors.size(); ++v) {
+        if (colors[v] >= num_colors) {
+            colors[v] = random.below(num_colors);
+        }
+    }
+}
+
+// Renumbers the colors of a legal coloring to 0..K-1 in order of first use and returns K
+static int compactColors(std::vector<int>& colors) {
+    std::vector<int> new_color;
+    int num_colors = 0;
+    for (size_t v = 1; v < colors.size(); ++v) {
+        if (colors[v] >= static_cast<int>(new_color.size())) {
+            new_color.resize(colors[v] + 1, -1);
+        }
+        if (new_color[colors[v]] < 0) {
+            new_color[colors[v]] = num_colors++;
+        }
+        colors[v] = new_color[colors[v]];
+    }
+    return num_colors;
+}
+
+// Greedy partition crossover (Galinier and Hao): the child's classes are taken alternately
+// from the two parents, each time the largest class counting only the vertices not placed
+// yet. The vertices left after num_colors classes get a random color.
+static void gpxCrossover(const std::vector<int>& parent_a, const std::vector<int>& parent_b, int num_colors,
+                         GraphRandom& random, std::vector<int>& child) {
+    int num_vertices = static_cast<int>(parent_a.size()) - 1;
+    const std::vector<int>* parents[2] = {&parent_a, &parent_b};
+    std::vector<int> class_start[2];
+    std::vector<int> class_members[2];
+    std::vector<int> class_size[2];
+    for (int p = 0; p < 2; ++p) {
+        const std::vector<int>& colors = *parents[p];
+        class_start[p].assign(num_colors + 1, 0);
+        for (int v = 1; v <= num_vertices; ++v) {
+            class_start[p][colors[v] + 1]++;
+        }
+        for (int c = 0; c < num_colors; ++c) {
+            class_start[p][c + 1] += class_start[p][c];
+        }
+        class_size[p].assign(num_colors, 0);
+        for (int c = 0; c < num_colors; ++c) {
+            class_size[p][c] = class_start[p][c + 1] - class_start[p][c];
+        }
+        class_members[p].resize(num_vertices);
+        std::vector<int> fill(class_start[p].begin(), class_start[p].end() - 1);
+        for (int v = 1; v <= num_vertices; ++v) {
+            class_members[p][fill[colors[v]]++] = v;
+        }
+    }
+
+    child.assign(num_vertices + 1, -1);
+    for (int c = 0; c < num_colors; ++c) {
+        int p = c % 2;
+        int largest = static_cast<int>(std::max_element(class_size[p].begin(), class_size[p].end()) - class_size[p].begin());
+        for (int i = class_start[p][largest]; i < class_start[p][largest + 1]; ++i) {
+            int v = class_members[p][i];
+            if (child[v] == -1) {
+                child[v] = c;
+                class_size[1 - p][(*parents[1 - p])[v]]--;
+            }
+        }
+        class_size[p][largest] = 0;
+    }
+    for (int v = 1; v <= num_vertices; ++v) {
+        if (child[v] == -1) {
+            child[v] = random.below(num_colors);
+        }
+    }
+}
+
+HEAResult runHybridEvolutionary(const Graph& graph, const HEAOptions& options) {
+    int num_vertices = graph.numVertices();
+    HEAResult result;
+    int population_size = std::max(2, options.population_size);
+    int num_threads = options.num_threads > 0 ? options.num_threads
+                                              : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    result.num_threads = num_threads;
+    auto start_time = std::chrono::steady_clock::now();
+    auto deadline = start_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                     std::chrono::duration<double, std::milli>(options.time_budget_ms));
+    auto elapsed_ms = [&start_time]() {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+    };
+    // Initial population: randomized DSATUR, RLF and LDO colorings, in parallel
+    const Algorithm seed_algorithms[] = {Algorithm::DSATUR, Algorithm::RLF, Algorithm::LargestDegreeOrdering};
+    std::vector<ColoringResult> seeds(population_size);
+    std::atomic<int> next_member(0);
+    runOnThreads(std::min(num_threads, population_size), [&](int) {
+        for (int i = next_member++; i < population_size; i = next_member++) {
+            ColoringOptions seed_options = options.coloring;
+            seed_options.randomize = true;
+            seed_options.seed = options.seed + i;
+            seeds[i] = colorGraph(graph, seed_algorithms[i % 3], seed_options);
+        }
+    });
+    int best_member = 0;
+    for (int i = 1; i < population_size; ++i) {
+        if (seeds[i].colors_used < seeds[best_member].colors_used) {
+            best_member = i;
+        }
+    }
+    result.coloring = seeds[best_member];
+    result.initial_colors = result.coloring.colors_used;
+    result.progress.push_back({elapsed_ms(), 0, result.coloring.colors_used});
+
+    // A team of threads started once for all generations. Each keeps its TabuCol, the
+    // tables allocated by the thread itself for the first (largest) target and reused by
+    // every later individual, and its random generator; fewer threads if their tables
+    // would exceed the limit.
+    int max_target = std::max(1, result.coloring.colors_used - 1);
+    size_t thread_bytes = TabuCol::tableBytes(num_vertices, max_target);
+    num_threads = static_cast<int>(std::max<size_t>(1, std::min<size_t>(num_threads, options.tabu_memory_limit / thread_bytes)));
+    result.num_threads = num_threads;
+    ThreadTeam team(num_threads);
+    std::vector<std::unique_ptr<TabuCol>> tabu_searches(num_threads);
+    std::vector<std::unique_ptr<GraphRandom>> randoms(num_threads);
+    team.run([&](int t) {
+        tabu_searches[t].reset(new TabuCol(graph));
+        tabu_searches[t]->reserveTables(max_target);
+        randoms[t].reset(new GraphRandom(options.seed * 0x9E3779B97F4A7C15ULL + static_cast<unsigned long long>(t)));
+    });
+    for (int t = 0; t < num_threads; ++t) {
+        result.tabu_table_bytes += tabu_searches[t]->reservedBytes();
+    }
+
+    // Search for a legal coloring with one color less than the best so far, over and over
+    std::vector<std::vector<int>> population(population_size);
+    std::vector<long long> member_conflicts(population_size, 0);
+    for (int i = 0; i < population_size; ++i) {
+        population[i] = std::move(seeds[i].colors);
+    }
+    std::vector<std::vector<int>> children(num_threads);
+    std::vector<long long> child_conflicts(num_threads, 0);
+    std::vector<std::pair<int, int>> child_parents(num_threads);
+    int target_colors = result.coloring.colors_used - 1;
+    bool repair_population = true; // The members must be restricted to target_colors and repaired
+    long long generation = 0;
+    while (target_colors >= 1 && target_colors >= options.target_colors && num_vertices > 0 &&
+           std::chrono::steady_clock::now() < deadline) {
+        int legal_child = -1;
+        if (repair_population) {
+            next_member = 0;
+            team.run([&](int t) {
+                GraphRandom& random = *randoms[t];
+                for (int i = next_member++; i < population_size; i = next_member++) {
+                    restrictColors(population[i], target_colors, random);
+                    member_conflicts[i] = tabu_searches[t]->run(population[i], target_colors, options.tabu_iterations,
+                                                                deadline, random);
+                }
+            });
+            repair_population = false;
+            for (int i = 0; i < population_size && legal_child < 0; ++i) {
+                if (member_conflicts[i] == 0) {
+                    children[0] = population[i];
+                    legal_child = 0;
+                }
+            }
+        }
+
+        if (legal_child < 0) {
+            // One generation: every thread crosses two random parents and improves the child
+            generation++;
+            team.run([&](int t) {
+                GraphRandom& random = *randoms[t];
+                int a = random.below(population_size);
+                int b = random.below(population_size - 1);
+                b += b >= a;
+                child_parents[t] = {a, b};
+                gpxCrossover(population[a], population[b], target_colors, random, children[t]);
+                child_conflicts[t] = tabu_searches[t]->run(children[t], target_colors, options.tabu_iterations, deadline, random);
+            });
+            for (int t = 0; t < num_threads && legal_child < 0; ++t) {
+                if (child_conflicts[t] == 0) {
+                    legal_child = t;
+                    break;
+                }
+                // The child replaces the worse of its parents
+                int a = child_parents[t].first;
+                int b = child_parents[t].second;
+                int replaced = member_conflicts[a] >= member_conflicts[b] ? a : b;
+                population[replaced] = children[t];
+                member_conflicts[replaced] = child_conflicts[t];
+            }
+        }
+
+        if (legal_child >= 0) {
+            result.coloring.colors = children[legal_child];
+            result.coloring.colors_used = compactColors(result.coloring.colors);
+            result.progress.push_back({elapsed_ms(), generation, result.coloring.colors_used});
+            target_colors = result.coloring.colors_used - 1;
+            repair_population = true;
+        }
+    }
+
+    result.generations = generation;
+    result.elapsed_ms = elapsed_ms();
+    result.coloring.elapsed_ms = result.elapsed_ms;
+    return result;
+}
+
+// The search of runPartialCol with k colors, from the greedy coloring in result.coloring
+template <typename GraphType>
+static void partial_col_search(const GraphType& graph, size_t k, const PartialColOptions& options,
+                               std::chrono::steady_clock::time_point start_time, PartialColResult& result) {
+    int num_vertices = graph.numVertices();
+    auto deadline = start_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                     std::chrono::duration<double, std::milli>(options.time_budget_ms));
+
+    // Start: the greedy coloring without the vertices of colors k and above
+    std::vector<int>& colors = result.coloring.colors;
+    IndexedVertexSet uncolored(num_vertices);
+    for (int v = 1; v <= num_vertices; ++v) {
+        if (colors[v] >= static_cast<int>(k)) {
+            colors[v] = -1;
+            uncolored.insert(v);
+        }
+    }
+    result.initial_uncolored = static_cast<int>(uncolored.size());
+
+    // conflict_table[v * k + c]: colored neighbors of v with color c
+    std::vector<int> conflict_table((num_vertices + 1) * k, 0);
+    std::vector<long long> tabu_until((num_vertices + 1) * k, 0);
+    for (int v = 1; v <= num_vertices; ++v) {
+        for (int neighbor_id : graph.neighbors(v)) {
+            if (colors[neighbor_id] >= 0) {
+                conflict_table[v * k + colors[neighbor_id]]++;
+            }
+        }
+    }
+    GraphRandom random(options.seed);
+    size_t best_uncolored = uncolored.size();
+    std::vector<int> best_colors = colors;
+    std::vector<int> evicted; // Neighbors uncolored by the current move
+
+    long long iteration = 0;
+    for (; !uncolored.empty() && (options.max_iterations <= 0 || iteration < options.max_iterations); ++iteration) {
+        if ((iteration & 255) == 0 && std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+        // Move: give an uncolored vertex v the color c and uncolor its neighbors of color
+        // c, changing the number of uncolored vertices by conflict_table[v * k + c] - 1.
+        // Best non-tabu move (or tabu but better than the best so far), random among equals.
+        int move_vertex = 0;
+        int move_color = -1;
+        int best_delta = 0;
+        int ties = 0;
+        for (size_t i = 0; i < uncolored.size(); ++i) {
+            int v = uncolored[i];
+            const int* row = &conflict_table[v * k];
+            const long long* tabu_row = &tabu_until[v * k];
+            for (int c = 0; c < static_cast<int>(k); ++c) {
+                int delta = row[c] - 1;
+                if (tabu_row[c] > iteration && static_cast<long long>(uncolored.size()) + delta >= static_cast<long long>(best_uncolored)) {
+                    continue;
+                }
+                if (move_vertex == 0 || delta < best_delta) {
+                    move_vertex = v;
+                    move_color = c;
+                    best_delta = delta;
+                    ties = 1;
+                } else if (delta == best_delta && random.below(++ties) == 0) {
+                    move_vertex = v;
+                    move_color = c;
+                }
+            }
+        }
+        if (move_vertex == 0) {
+            continue; // Every move is tabu
+        }
+
+        colors[move_vertex] = move_color;
+        uncolored.remove(move_vertex);
+        evicted.clear();
+        for (int neighbor_id : graph.neighbors(move_vertex)) {
+            conflict_table[neighbor_id * k + move_color]++;
+            if (colors[neighbor_id] == move_color) {
+                evicted.push_back(neighbor_id);
+            }
+        }
+        long long tenure = static_cast<long long>(0.6 * (uncolored.size() + evicted.size())) + random.below(10);
+        for (int u : evicted) {
+            colors[u] = -1;
+            uncolored.insert(u);
+            tabu_until[u * k + move_color] = iteration + tenure; // u may not take its old color back for a while
+            for (int neighbor_id : graph.neighbors(u)) {
+                conflict_table[neighbor_id * k + move_color]--;
+            }
+        }
+        if (uncolored.size() < best_uncolored) {
+            best_uncolored = uncolored.size();
+            best_colors = colors;
+        }
+    }
+
+    colors.swap(best_colors);
+    result.uncolored = static_cast<int>(best_uncolored);
+    result.success = best_uncolored == 0;
+    result.coloring.colors_used = result.success ? compactColors(colors) : static_cast<int>(k);
+    result.iterations = iteration;
+    result.elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+    result.coloring.elapsed_ms = result.elapsed_ms;
+    result.iterations_per_second = result.elapsed_ms > 0.0 ? iteration * 1000.0 / result.elapsed_ms : 0.0;
+}
+
+PartialColResult runPartialCol(const Graph& graph, int num_colors, const PartialColOptions& options) {
+    size_t k = static_cast<size_t>(std::max(1, num_colors));
+    PartialColResult result;
+    auto start_time = std::chrono::steady_clock::now();
+    result.coloring = colorGraph(graph, options.initial_algorithm);
+    graph.visit([&](const auto& view) { partial_col_search(view, k, options, start_time, result); });
+    return result;
+}
+
+// Recolors single vertices for reduceColorsByKempeChains. All buffers are sized once, so
+// trying a chain never allocates: visits are marked with a stamp that changes per chain.
+template <typename GraphType>
+class KempeRecolorer {
+public:
+    KempeRecolorer(const GraphType& graph, std::vector<int>& colors, int num_colors, KempeReductionResult& result)
+        : graph_(graph), colors_(colors), result_(result), visit_stamp_(graph.numVertices() + 1, 0),
+          neighbor_stamp_(graph.numVertices() + 1, 0), neighbor_color_count_(num_colors, 0) {
+        chain_.reserve(graph.numVertices());
+    }
+
+    // Moves vertex out of its class into another of the num_colors classes, directly if
+    // some color is free among its neighbors, otherwise after swapping a Kempe chain.
+    // Returns false (and changes nothing) if neither works, or if the deadline passes
+    // before a chain is found: a vertex can try O(k^2) chains, each a BFS.
+    bool recolorVertex(int vertex, int num_colors, std::chrono::steady_clock::time_point deadline) {
+        int own_color = colors_[vertex];
+        for (int neighbor_id : graph_.neighbors(vertex)) {
+            if (colors_[neighbor_id] >= 0) { // Uncolored neighbors constrain nothing
+                neighbor_color_count_[colors_[neighbor_id]]++;
+            }
+        }
+        bool moved = false;
+        for (int c = 0; c < num_colors && !moved; ++c) {
+            if (c != own_color && neighbor_color_count_[c] == 0) {
+                colors_[vertex] = c;
+                result_.direct_moves++;
+                moved = true;
+            }
+        }
+        // Free color c at vertex: swap c and d on the chains through its c-colored neighbors,
+        // provided those chains reach none of its d-colored neighbors
+        for (int c = 0; c < num_colors && !moved; ++c) {
+            if (c == own_color) {
+                continue;
+            }
+            for (int d = 0; d < num_colors && !moved; ++d) {
+                if (std::chrono::steady_clock::now() >= deadline) {
+                    c = num_colors; // Gives up on the vertex
+                    break;
+                }
+                if (d != own_color && d != c && swapChains(vertex, c, d)) {
+                    colors_[vertex] = c;
+                    result_.chain_swaps++;
+                    moved = true;
+                }
+            }
+        }
+        // Chain swaps may have recolored neighbors, so clear all counts rather than theirs
+        std::fill(neighbor_color_count_.begin(), neighbor_color_count_.begin() + num_colors, 0);
+        return moved;
+    }
+
+private:
+    // BFS over the subgraph of colors c and d from the c-colored neighbors of vertex. If it
+    // never reaches a d-colored neighbor of vertex, the two colors are swapped on it.
+    bool swapChains(int vertex, int c, int d) {
+        stamp_++;
+        chain_.clear();
+        for (int neighbor_id : graph_.neighbors(vertex)) {
+            neighbor_stamp_[neighbor_id] = stamp_;
+            if (colors_[neighbor_id] == c) {
+                visit_stamp_[neighbor_id] = stamp_;
+                chain_.push_back(neighbor_id);
+            }
+        }
+        for (size_t head = 0; head < chain_.size(); ++head) {
+            int u = chain_[head];
+            int other_color = colors_[u] == c ? d : c;
+            for (int w : graph_.neighbors(u)) {
+                if (colors_[w] != other_color || visit_stamp_[w] == stamp_) {
+                    continue;
+                }
+                if (other_color == d && neighbor_stamp_[w] == stamp_) {
+                    return false; // Would give vertex a new c-colored neighbor
+                }
+                visit_stamp_[w] = stamp_;
+                chain_.push_back(w);
+            }
+        }
+        for (int u : chain_) {
+            colors_[u] = colors_[u] == c ? d : c;
+        }
+        return true;
+    }
+
+    const GraphType& graph_;
+    std::vector<int>& colors_;
+    KempeReductionResult& result_;
+    unsigned stamp_ = 0;
+    std::vector<unsigned> visit_stamp_;
+    std::vector<unsigned> neighbor_stamp_;
+    std::vector<int> neighbor_color_count_;
+    std::vector<int> chain_;
+};
+
+template <typename GraphType>
+static KempeReductionResult reduce_colors_by_kempe_chains(const GraphType& graph, const ColoringResult& initial,
+                                                          const KempeReductionOptions& options) {
+    int num_vertices = graph.numVertices();
+    KempeReductionResult result;
+    result.coloring = initial;
+    result.initial_colors = initial.colors_used;
+    auto start_time = std::chrono::steady_clock::now();
+    auto elapsed_ms = [&start_time]() {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+    };
+    std::vector<int>& colors = result.coloring.colors;
+    int num_colors = initial.colors_used;
+    for (int v = 1; v <= num_vertices; ++v) {
+        if (colors[v] >= num_colors) {
+            num_colors = 0; // Not a coloring with colors_used colors: returned unchanged
+        }
+    }
+    auto deadline = start_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                     std::chrono::duration<double, std::milli>(options.time_budget_ms));
+    KempeRecolorer<GraphType> recolorer(graph, colors, std::max(num_colors, 0), result);
+    std::vector<int> class_size(num_colors, 0);
+    std::vector<int> members;
+
+    // Try to empty the classes from the smallest up; after every success start over
+    bool emptied_class = true;
+    while (emptied_class && num_colors > 1 && elapsed_ms() < options.time_budget_ms) {
+        emptied_class = false;
+        class_size.assign(num_colors, 0);
+        for (int v = 1; v <= num_vertices; ++v) {
+            if (colors[v] >= 0) {
+                class_size[colors[v]]++;
+            }
+        }
+        std::vector<int> class_order(num_colors);
+        std::iota(class_order.begin(), class_order.end(), 0);
+        std::stable_sort(class_order.begin(), class_order.end(),
+                         [&class_size](int a, int b) { return class_size[a] < class_size[b]; });
+
+        for (int target : class_order) {
+            if (elapsed_ms() >= options.time_budget_ms) {
+                break;
+            }
+            members.clear();
+            for (int v = 1; v <= num_vertices; ++v) {
+                if (colors[v] == target) {
+                    members.push_back(v);
+                }
+            }
+            bool all_moved = true;
+            for (int v : members) {
+                if (!recolorer.recolorVertex(v, num_colors, deadline)) {
+                    all_moved = false;
+                    break;
+                }
+            }
+            if (all_moved) {
+                // The last color takes the place of the emptied one
+                for (int v = 1; v <= num_vertices; ++v) {
+                    if (colors[v] == num_colors - 1) {
+                        colors[v] = target;
+                    }
+                }
+                num_colors--;
+                result.classes_removed++;
+                emptied_class = true;
+                break;
+            }
+        }
+    }
+
+    result.coloring.colors_used = num_colors > 0 ? num_colors : initial.colors_used;
+    result.elapsed_ms = elapsed_ms();
+    result.coloring.elapsed_ms = initial.elapsed_ms + result.elapsed_ms;
+    return result;
+}
+
+KempeReductionResult reduceColorsByKempeChains(const Graph& graph, const ColoringResult& initial,
+                                               const KempeReductionOptions& options) {
+    return graph.visit([&](const auto& view) { return reduce_colors_by_kempe_chains(view, initial, options); });
+}
+
+DynamicColoring::DynamicColoring(const Graph& graph, const std::vector<int>& colors)
+    : adjacency_(graph.numVertices() + 1), twin_(graph.numVertices() + 1), active_(graph.numVertices() + 1, true),
+      colors_(colors), num_vertices_(graph.numVertices()), num_edges_(0) {
+    active_[0] = false;
+    colors_.resize(graph.numVertices() + 1, -1);
+    colors_[0] = -1;
+    graph.visit([this](const auto& view) {
+        for (int v = 1; v <= view.numVertices(); ++v) {
+            adjacency_[v].assign(view.neighbors(v).begin(), view.neighbors(v).end());
+        }
+    });
+    for (int v = 1; v <= graph.numVertices(); ++v) {
+        num_edges_ += graph.degree(v);
+        int c = colors_[v];
+        if (c < 0) {
+            continue; // Colored below
+        }
+        if (c >= static_cast<int>(class_size_.size())) {
+            class_size_.resize(c + 1, 0);
+        }
+        if (class_size_[c]++ == 0) {
+            nonempty_classes_++;
+        }
+    }
+    num_edges_ /= 2;
+    for (int v = 1; v <= graph.numVertices(); ++v) {
+        twin_[v].resize(adjacency_[v].size());
+        for (size_t i = 0; i < adjacency_[v].size(); ++i) {
+            const std::vector<int>& other = adjacency_[adjacency_[v][i]]; // Sorted
+            twin_[v][i] = static_cast<int>(std::lower_bound(other.begin(), other.end(), v) - other.begin());
+        }
+    }
+    // Vertices the coloring leaves out (-1, or beyond its end) get their first free color
+    for (int v = 1; v <= graph.numVertices(); ++v) {
+        if (colors_[v] < 0) {
+            setColor(v, firstFreeColor(v));
+        }
+    }
+    stats_ = DynamicColoringStats();
+}
+
+void DynamicColoring::pushEdgeEntries(int u, int v) {
+    twin_[u].push_back(static_cast<int>(adjacency_[v].size()));
+    twin_[v].push_back(static_cast<int>(adjacency_[u].size()));
+    adjacency_[u].push_back(v);
+    adjacency_[v].push_back(u);
+    num_edges_++;
+}
+
+// Removes entry index of vertex's list, moving the last entry into its place
+void DynamicColoring::removeEntry(int vertex, int index) {
+    std::vector<int>& list = adjacency_[vertex];
+    std::vector<int>& twins = twin_[vertex];
+    int last = static_cast<int>(list.size()) - 1;
+    if (index != last) {
+        list[index] = list[last];
+        twins[index] = twins[last];
+        twin_[list[index]][twins[index]] = index;
+    }
+    list.pop_back();
+    twins.pop_back();
+}
+bool DynamicColoring::hasEdge(int u, int v) const {
+    if (!hasVertex(u) || !hasVertex(v)) {
+        return false;
+    }
+    const std::vector<int>& shorter = adjacency_[u].size() <= adjacency_[v].size() ? adjacency_[u] : adjacency_[v];
+    int other = &shorter == &adjacency_[u] ? v : u;
+    return std::find(shorter.begin(), shorter.end(), other) != shorter.end();
+}
+
+// Smallest color no neighbor of vertex other than skip has, besides also_forbidden (-1 for
+// none); class_size_.size() means a new class. Only the words set here are cleared after,
+// so a repair costs O(degree) plus the words scanned, not a fill of the whole palette.
+int DynamicColoring::firstFreeColor(int vertex, int skip, int also_forbidden) {
+    size_t num_words = class_size_.size() / 64 + 1;
+    if (forbidden_words_.size() < num_words) {
+        forbidden_words_.resize(num_words, 0);
+    }
+    for (int neighbor_id : adjacency_[vertex]) {
+        int c = colors_[neighbor_id];
+        if (c >= 0 && neighbor_id != skip) {
+            forbidden_words_[c >> 6] |= uint64_t(1) << (c & 63);
+        }
+    }
+    if (also_forbidden >= 0) {
+        forbidden_words_[also_forbidden >> 6] |= uint64_t(1) << (also_forbidden & 63);
+    }
+    int color = findFirstZeroBit(forbidden_words_.data(), num_words);
+    for (int neighbor_id : adjacency_[vertex]) {
+        if (colors_[neighbor_id] >= 0) {
+            forbidden_words_[colors_[neighbor_id] >> 6] = 0;
+        }
+    }
+    if (also_forbidden >= 0) {
+        forbidden_words_[also_forbidden >> 6] = 0;
+    }
+    return color;
+}
+
+// Gives vertex an existing color c held by a single neighbor w, moving w to another
+// existing color (not c). Tries at most kMaxNeighborMoves such neighbors. Returns false,
+// changing nothing, if none can move.
+bool DynamicColoring::recolorThroughNeighbor(int vertex) {
+    const int kMaxNeighborMoves = 16;
+    int palette = static_cast<int>(class_size_.size());
+    if (static_cast<int>(neighbor_color_count_.size()) < palette) {
+        neighbor_color_count_.resize(palette, 0);
+    }
+    for (int neighbor_id : adjacency_[vertex]) {
+        if (colors_[neighbor_id] >= 0) {
+            neighbor_color_count_[colors_[neighbor_id]]++;
+        }
+    }
+    int moving = -1;
+    int moving_color = -1;
+    int tries = 0;
+    for (int neighbor_id : adjacency_[vertex]) {
+        int c = colors_[neighbor_id];
+        if (c < 0 || neighbor_color_count_[c] != 1) {
+            continue;
+        }
+        if (++tries > kMaxNeighborMoves) {
+            break;
+        }
+        moving_color = firstFreeColor(neighbor_id, vertex, c);
+        if (moving_color < palette) {
+            moving = neighbor_id;
+            break;
+        }
+    }
+    for (int neighbor_id : adjacency_[vertex]) {
+        if (colors_[neighbor_id] >= 0) {
+            neighbor_color_count_[colors_[neighbor_id]] = 0;
+        }
+    }
+    if (moving < 0) {
+        return false;
+    }
+    int freed_color = colors_[moving];
+    setColor(moving, moving_color);
+    setColor(vertex, freed_color);
+    stats_.neighbor_moves++;
+    return true;
+}
+
+void DynamicColoring::setColor(int vertex, int color) {
+    int old_color = colors_[vertex];
+    if (old_color >= 0 && --class_size_[old_color] == 0) {
+        nonempty_classes_--;
+    }
+    if (color == static_cast<int>(class_size_.size())) {
+        class_size_.push_back(0);
+        stats_.new_colors++;
+    }
+    if (class_size_[color]++ == 0) {
+        nonempty_classes_++;
+    }
+    colors_[vertex] = color;
+}
+
+void DynamicColoring::recordUpdate(int recolored) {
+    stats_.updates++;
+    stats_.recolored_vertices += recolored;
+    stats_.max_recolored = std::max(stats_.max_recolored, recolored);
+}
+
+int DynamicColoring::addEdge(int u, int v) {
+    if (u == v || hasEdge(u, v) || !hasVertex(u) || !hasVertex(v)) {
+        return 0;
+    }
+    pushEdgeEntries(u, v);
+    int recolored = 0;
+    if (colors_[u] == colors_[v]) {
+        // Repair the conflict at one endpoint, avoiding a new class if possible: the
+        // smaller endpoint's first free color, the other's, then a move of one neighbor
+        if (adjacency_[u].size() > adjacency_[v].size()) {
+            std::swap(u, v);
+        }
+        int palette = static_cast<int>(class_size_.size());
+        int color_u = firstFreeColor(u);
+        int color_v = color_u < palette ? palette : firstFreeColor(v);
+        if (color_u < palette) {
+            setColor(u, color_u);
+            recolored = 1;
+        } else if (color_v < palette) {
+            setColor(v, color_v);
+            recolored = 1;
+        } else if (recolorThroughNeighbor(u) || recolorThroughNeighbor(v)) {
+            recolored = 2;
+        } else {
+            setColor(u, color_u);
+            recolored = 1;
+        }
+    }
+    recordUpdate(recolored);
+    return recolored;
+}
+
+int DynamicColoring::removeEdge(int u, int v) {
+    if (!hasVertex(u) || !hasVertex(v)) {
+        return 0;
+    }
+    if (adjacency_[u].size() > adjacency_[v].size()) {
+        std::swap(u, v);
+    }
+    auto position = std::find(adjacency_[u].begin(), adjacency_[u].end(), v);
+    if (position == adjacency_[u].end()) {
+        return 0;
+    }
+    int index = static_cast<int>(position - adjacency_[u].begin());
+    removeEntry(v, twin_[u][index]);
+    removeEntry(u, index);
+    num_edges_--;
+    recordUpdate(0);
+    return 0;
+}
+
+int DynamicColoring::removeVertex(int v) {
+    if (!hasVertex(v)) {
+        return 0;
+    }
+    for (size_t i = 0; i < adjacency_[v].size(); ++i) {
+        removeEntry(adjacency_[v][i], twin_[v][i]);
+    }
+    num_edges_ -= static_cast<long long>(adjacency_[v].size());
+    std::vector<int>().swap(adjacency_[v]);
+    std::vector<int>().swap(twin_[v]);
+    if (--class_size_[colors_[v]] == 0) {
+        nonempty_classes_--;
+    }
+    colors_[v] = -1;
+    active_[v] = false;
+    num_vertices_--;
+    recordUpdate(0);
+    return 0;
+}
+
+int DynamicColoring::addVertex(const std::vector<int>& neighbors) {
+    int v = static_cast<int>(adjacency_.size());
+    adjacency_.emplace_back();
+    twin_.emplace_back();
+    active_.push_back(true);
+    colors_.push_back(-1);
+    std::vector<int> unique_neighbors = neighbors;
+    std::sort(unique_neighbors.begin(), unique_neighbors.end());
+    unique_neighbors.erase(std::unique(unique_neighbors.begin(), unique_neighbors.end()), unique_neighbors.end());
+    for (int neighbor_id : unique_neighbors) {
+        if (hasVertex(neighbor_id)) {
+            pushEdgeEntries(v, neighbor_id);
+        }
+    }
+    num_vertices_++;
+    int color = firstFreeColor(v);
+    int recolored = 1;
+    if (color < static_cast<int>(class_size_.size()) || !recolorThroughNeighbor(v)) {
+        setColor(v, color);
+    } else {
+        recolored = 2;
+    }
+    recordUpdate(recolored);
+    return v;
+}
+
+Graph DynamicColoring::graph() const {
+    std::vector<Vertex> vertices(adjacency_.size());
+    for (size_t v = 1; v < adjacency_.size(); ++v) {
+        vertices[v].id = static_cast<int>(v);
+        vertices[v].neighbors = adjacency_[v];
+        std::sort(vertices[v].neighbors.begin(), vertices[v].neighbors.end());
+        vertices[v].degree = static_cast<int>(vertices[v].neighbors.size());
+    }
+    return Graph(std::move(vertices), static_cast<int>(num_edges_));
+}
+
+ColoringResult DynamicColoring::coloring() const {
+    ColoringResult result;
+    std::vector<int> new_color(class_size_.size(), -1);
+    int num_colors = 0;
+    for (size_t c = 0; c < class_size_.size(); ++c) {
+        if (class_size_[c] > 0) {
+            new_color[c] = num_colors++;
+        }
+    }
+    result.colors.assign(colors_.size(), -1);
+    for (size_t v = 1; v < colors_.size(); ++v) {
+        if (colors_[v] >= 0) {
+            result.colors[v] = new_color[colors_[v]];
+        }
+    }
+    result.colors_used = num_colors;
+    return result;
+}
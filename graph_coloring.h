@@ -0,0 +1,869 @@
+#ifndef GRAPH_COLORING_H
+#define GRAPH_COLORING_H
+
+// Graph coloring library: graph type, loaders, synthetic generators, relabeling and the
+// six greedy coloring algorithms (FF, WP, LDO, IDO, DSATUR, RLF) plus variants.
+// The colorers only read the graph and keep their state in the call, so one Graph can
+// be colored by several threads at the same time.
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#if defined(__SSSE3__)
+#include <tmmintrin.h> // Compressed neighbor list decoding (build with -march=native or GC_NATIVE)
+#endif
+
+// Structure to represent a vertex. Loaders and generators build a graph as an array of
+// these, which Graph then packs into its compact arrays.
+struct Vertex {
+    int id;
+    int degree; // Number of distinct neighbors
+    std::vector<int> neighbors; // Sorted vertex IDs
+
+    // Default constructor for vector resizing and initialization
+    Vertex(int i = 0) : id(i), degree(0) {}
+};
+
+// The neighbor IDs of one vertex as stored by a Graph, Id being uint16_t or uint32_t
+template <typename Id>
+class NeighborSpan {
+public:
+    NeighborSpan(const Id* first, const Id* last) : first_(first), last_(last) {}
+
+    const Id* begin() const { return first_; }
+    const Id* end() const { return last_; }
+    size_t size() const { return static_cast<size_t>(last_ - first_); }
+    bool empty() const { return first_ == last_; }
+    int operator[](size_t i) const { return first_[i]; }
+
+private:
+    const Id* first_;
+    const Id* last_;
+};
+
+// Read-only view of a Graph with the neighbor IDs typed as Id. Graph::visit() passes one
+// to a generic function, so every coloring engine is compiled once per ID width and
+// never checks the width inside its loops.
+template <typename Id>
+class GraphView {
+public:
+    using IdType = Id;
+
+    GraphView(const size_t* offsets, const Id* ids, int num_vertices, int num_edges)
+        : offsets_(offsets), ids_(ids), num_vertices_(num_vertices), num_edges_(num_edges) {}
+
+    int numVertices() const { return num_vertices_; }
+    int numEdges() const { return num_edges_; }
+    int degree(int v) const { return static_cast<int>(offsets_[v + 1] - offsets_[v]); }
+    NeighborSpan<Id> neighbors(int v) const { return NeighborSpan<Id>(ids_ + offsets_[v], ids_ + offsets_[v + 1]); }
+
+private:
+    const size_t* offsets_;
+    const Id* ids_;
+    int num_vertices_;
+    int num_edges_;
+};
+
+// Reads one LEB128 varint (7 bits per byte, low bits first) and advances bytes past it.
+// Compressed rows start with their degree in this form.
+inline uint32_t decodeVarint(const uint8_t*& bytes) {
+    uint32_t byte = *bytes++;
+    if (byte < 0x80) {
+        return byte;
+    }
+    uint32_t value = byte & 0x7F;
+    int shift = 7;
+    do {
+        byte = *bytes++;
+        value |= (byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return value;
+}
+
+#if defined(__SSSE3__)
+// Per control byte of a compressed neighbor list (four 2-bit length codes): the data bytes
+// of its four values, and the byte shuffle that widens them to four 32-bit integers
+struct PackedGroupTables {
+    uint8_t length[256];
+    uint8_t shuffle[256][16];
+};
+
+constexpr PackedGroupTables makePackedGroupTables() {
+    PackedGroupTables tables{};
+    for (int control = 0; control < 256; ++control) {
+        int offset = 0;
+        for (int i = 0; i < 4; ++i) {
+            int length = ((control >> (i * 2)) & 3) + 1;
+            for (int b = 0; b < 4; ++b) {
+                tables.shuffle[control][i * 4 + b] = static_cast<uint8_t>(b < length ? offset + b : 0x80); // 0x80: zero
+            }
+            offset += length;
+        }
+        tables.length[control] = static_cast<uint8_t>(offset);
+    }
+    return tables;
+}
+
+inline constexpr PackedGroupTables kPackedGroupTables = makePackedGroupTables();
+#endif
+
+// Forward iterator over a compressed neighbor list. The list is StreamVByte-style: a 2-bit
+// length code (1 to 4 bytes) per value, four to a control byte, ahead of the little-endian
+// values. The first value is the first neighbor's zigzag coded offset from the vertex
+// itself, the others are the gaps between consecutive neighbors minus one (see
+// Graph::compressAdjacency). With SSSE3 (-march=native or GC_NATIVE) the four values of a
+// control byte are decoded together, widened by one shuffle and turned into IDs by a
+// prefix sum; otherwise one value is decoded per step, without data-dependent branches,
+// which measured faster than four masked loads and a scalar prefix sum.
+class PackedNeighborIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = int;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const int*;
+    using reference = int;
+
+    PackedNeighborIterator() = default;
+    // Decodes the first value (with SSSE3 the first four) even past the end of a shorter
+    // list; the rows are padded so this never leaves the array
+    PackedNeighborIterator(const uint8_t* controls, const uint8_t* data, int vertex)
+        : controls_(controls), data_(data), index_(0) {
+        uint32_t zigzag = nextValue();
+        int first = vertex + static_cast<int>((zigzag >> 1) ^ (0u - (zigzag & 1)));
+#if defined(__SSSE3__)
+        // The group adds zigzag + 1 to the base for the first value, like a gap
+        data_ = data;
+        decodeGroup(static_cast<uint32_t>(first) - zigzag - 1);
+#else
+        value_ = first;
+#endif
+    }
+
+#if defined(__SSSE3__)
+    int operator*() const { return values_[index_ & 3]; }
+    PackedNeighborIterator& operator++() {
+        if ((++index_ & 3) == 0) {
+            decodeGroup(static_cast<uint32_t>(values_[3]));
+        }
+        return *this;
+    }
+#else
+    int operator*() const { return value_; }
+    PackedNeighborIterator& operator++() {
+        ++index_;
+        value_ += static_cast<int>(nextValue()) + 1;
+        return *this;
+    }
+#endif
+    PackedNeighborIterator operator++(int) {
+        PackedNeighborIterator previous = *this;
+        ++*this;
+        return previous;
+    }
+    // Iterators of one list compare by position
+    bool operator==(const PackedNeighborIterator& other) const { return index_ == other.index_; }
+    bool operator!=(const PackedNeighborIterator& other) const { return index_ != other.index_; }
+
+private:
+    friend class PackedNeighborSpan;
+    explicit PackedNeighborIterator(int index) : index_(index) {}
+
+    // Decodes value index_ and moves data_ past it
+    uint32_t nextValue() {
+        uint32_t code = (controls_[index_ >> 2] >> ((index_ & 3) * 2)) & 3;
+        uint32_t word;
+        std::memcpy(&word, data_, sizeof(word));
+        data_ += code + 1;
+        return word & (0xFFFFFFFFu >> ((3 - code) * 8));
+    }
+
+#if defined(__SSSE3__)
+    // Decodes the four values of the control byte of index_ into values_: base plus the
+    // running sums of value + 1
+    void decodeGroup(uint32_t base) {
+        uint32_t control = controls_[index_ >> 2];
+        __m128i raw = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data_)),
+                                       _mm_loadu_si128(reinterpret_cast<const __m128i*>(kPackedGroupTables.shuffle[control])));
+        __m128i sums = _mm_add_epi32(raw, _mm_set1_epi32(1));
+        sums = _mm_add_epi32(sums, _mm_slli_si128(sums, 4));
+        sums = _mm_add_epi32(sums, _mm_slli_si128(sums, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(values_), _mm_add_epi32(sums, _mm_set1_epi32(static_cast<int>(base))));
+        data_ += kPackedGroupTables.length[control];
+    }
+#endif
+
+    const uint8_t* controls_ = nullptr;
+    const uint8_t* data_ = nullptr; // Past the values decoded so far
+    int index_ = 0;                 // Of the current value
+#if defined(__SSSE3__)
+    int values_[4] = {0, 0, 0, 0};  // The IDs of the control byte of the current value
+#else
+    int value_ = 0;
+#endif
+};
+
+// The neighbor IDs of one vertex of a compressed graph. Its row is the degree as a varint,
+// then ceil(degree / 4) control bytes, then the values.
+class PackedNeighborSpan {
+public:
+    PackedNeighborSpan(const uint8_t* row, int vertex)
+        : size_(static_cast<int>(decodeVarint(row))), controls_(row), vertex_(vertex) {}
+
+    PackedNeighborIterator begin() const {
+        return PackedNeighborIterator(controls_, controls_ + (size_ + 3) / 4, vertex_);
+    }
+    PackedNeighborIterator end() const { return PackedNeighborIterator(size_); }
+    size_t size() const { return static_cast<size_t>(size_); }
+    bool empty() const { return size_ == 0; }
+
+private:
+    int size_;
+    const uint8_t* controls_;
+    int vertex_;
+};
+
+// Read-only view of a Graph after compressAdjacency(), used like GraphView. Row v starts
+// at byte block_offsets[v >> kBlockShift] + row_offsets[v], so the per-vertex offsets
+// only need 32 bits.
+class CompressedGraphView {
+public:
+    static const int kBlockShift = 8;
+
+    CompressedGraphView(const uint8_t* bytes, const uint64_t* block_offsets, const uint32_t* row_offsets,
+                        int num_vertices, int num_edges)
+        : bytes_(bytes), block_offsets_(block_offsets), row_offsets_(row_offsets),
+          num_vertices_(num_vertices), num_edges_(num_edges) {}
+
+    int numVertices() const { return num_vertices_; }
+    int numEdges() const { return num_edges_; }
+    int degree(int v) const {
+        const uint8_t* row = this->row(v);
+        return static_cast<int>(decodeVarint(row));
+    }
+    PackedNeighborSpan neighbors(int v) const { return PackedNeighborSpan(row(v), v); }
+
+private:
+    const uint8_t* row(int v) const { return bytes_ + block_offsets_[v >> kBlockShift] + row_offsets_[v]; }
+
+    const uint8_t* bytes_;
+    const uint64_t* block_offsets_;
+    const uint32_t* row_offsets_;
+    int num_vertices_;
+    int num_edges_;
+};
+
+// Undirected simple graph with vertices 1..numVertices(). Vertex 0 is unused, so IDs
+// match the input files. The adjacency is kept in compressed sparse row form: the sorted
+// neighbor lists back to back in one ID array, and a row offset per vertex from which
+// the degrees follow. IDs are 16-bit when every vertex ID fits (fewer than 65536
+// vertices) and 32-bit otherwise, decided when the graph is built; visit() gives access
+// to the neighbor lists with the matching type. compressAdjacency() replaces the arrays
+// by delta coded rows for graphs that would not fit in memory otherwise.
+class Graph {
+public:
+    Graph() = default;
+    // Takes a 1-indexed vertex array (element 0 unused); num_edges is the declared edge count
+    Graph(std::vector<Vertex> vertices, int num_edges);
+
+    int numVertices() const { return num_vertices_; }
+    int numEdges() const { return num_edges_; } // As declared by the input, e.g. the 'p' line
+    int degree(int v) const {
+        return compressed_ ? compressedView().degree(v) : static_cast<int>(offsets_[v + 1] - offsets_[v]);
+    }
+    int idBytes() const { return wide_ids_ ? 4 : 2; } // Bytes per neighbor ID, unless compressed
+    bool compressed() const { return compressed_; }
+
+    // Re-encodes the adjacency: every row becomes the degree, the first neighbor relative
+    // to the vertex and the gaps to the following neighbors, each in 1 to 4 bytes (see
+    // PackedNeighborIterator). Small gaps (after --relabel, or in geometric graphs) take
+    // one byte instead of two or four, at the cost of decoding every scan: about 2.3x
+    // smaller on an RCM ordered geometric graph and, with SSSE3 group decoding, 1.1-1.6x
+    // slower for First Fit (see the README), so meant for graphs that do not fit in memory
+    // otherwise. Returns false, leaving the graph as it is, if a block of rows exceeds the
+    // 32-bit row offsets.
+    bool compressAdjacency();
+
+    // Calls f(view) with the GraphView<uint16_t>, GraphView<uint32_t> or
+    // CompressedGraphView of the graph and returns what it returns. f is typically a
+    // generic lambda.
+    template <typename F>
+    auto visit(F&& f) const {
+        if (compressed_) {
+            return f(compressedView());
+        }
+        if (wide_ids_) {
+            return f(GraphView<uint32_t>(offsets_.data(), wide_.data(), num_vertices_, num_edges_));
+        }
+        return f(GraphView<uint16_t>(offsets_.data(), narrow_.data(), num_vertices_, num_edges_));
+    }
+
+    // Moves the graph out as a vertex array, leaving the graph empty
+    std::vector<Vertex> release();
+
+private:
+    friend size_t graphMemoryBytes(const Graph& graph);
+
+    CompressedGraphView compressedView() const {
+        return CompressedGraphView(packed_.data(), block_offsets_.data(), row_offsets_.data(), num_vertices_, num_edges_);
+    }
+
+    std::vector<size_t> offsets_;  // Row of v: [offsets_[v], offsets_[v + 1]) in the ID array
+    std::vector<uint16_t> narrow_; // Neighbor IDs unless wide_ids_
+    std::vector<uint32_t> wide_;   // Neighbor IDs if wide_ids_
+    bool wide_ids_ = false;
+    std::vector<uint8_t> packed_;         // Compressed rows, replacing the arrays above
+    std::vector<uint64_t> block_offsets_; // First byte of every block of rows
+    std::vector<uint32_t> row_offsets_;   // First byte of each row within its block
+    bool compressed_ = false;
+    int num_vertices_ = 0;
+    int num_edges_ = 0;
+};
+
+// --- Loading ---
+
+// What readGraphFile found in the edge lines besides the simple graph it keeps
+struct GraphLoadStats {
+    long long edge_lines = 0;      // 'e' lines read
+    long long self_loops = 0;      // Edges (v, v), dropped
+    long long duplicate_edges = 0; // Repeated edges (in either direction), dropped
+    long long invalid_edges = 0;   // Edges with vertex IDs outside 1..n, dropped
+    long long simple_edges = 0;    // Distinct undirected edges kept
+};
+
+// Input formats readGraphFile accepts
+enum class GraphFormat { Auto, Dimacs, DimacsBinary, Metis, EdgeList };
+
+// Parses "auto", "dimacs", "dimacs-binary", "metis" or "edgelist". Returns false if unknown.
+bool parseGraphFormat(const std::string& name, GraphFormat& format);
+std::string graphFormatName(GraphFormat format);
+
+// Reads a graph file into graph. The format is detected unless given, gzip, zstd and xz
+// compressed files are decompressed on the fly, and with num_threads > 1 large ASCII
+// DIMACS files are parsed in parallel. Self-loops, duplicated and out-of-range edges are
+// dropped and counted in stats. Returns false (with a message on stderr) on failure.
+bool readGraphFile(const std::string& filename, Graph& graph, GraphLoadStats& stats,
+                   GraphFormat format = GraphFormat::Auto, int num_threads = 1);
+
+// --- Synthetic graphs ---
+
+// Parameters of a synthetic graph, parsed from specs like "gnp:n=1000,p=0.5,seed=1"
+struct GraphGeneratorSpec {
+    std::string family;      // gnp, geo, leighton or flat
+    int n = 1000;            // Number of vertices
+    double p = 0.5;          // Edge probability (gnp, flat)
+    double r = 0.1;          // Connection radius in the unit square (geo)
+    int k = 25;              // Planted number of colors (leighton, flat)
+    long long m = 0;         // Target number of edges (leighton)
+    unsigned long long seed = 1;
+};
+
+// Parses a generator spec. Returns false (with a message) for unknown families or keys.
+bool parseGeneratorSpec(const std::string& text, GraphGeneratorSpec& spec);
+std::string generatorSpecName(const GraphGeneratorSpec& spec);
+
+// Builds a deterministic synthetic graph; numEdges() is the number of distinct edges
+void generateGraph(const GraphGeneratorSpec& spec, Graph& graph);
+
+// --- Graph cache ---
+
+// Heap bytes held by a graph: its row offsets and neighbor IDs (or compressed rows), by capacity
+size_t graphMemoryBytes(const Graph& graph);
+
+struct GraphCacheStats {
+    long long hits = 0;      // Lookups served from the cache, including waits for a load in progress
+    long long misses = 0;    // Loads and generations, including reloads of changed files
+    long long evictions = 0; // Graphs dropped to stay within the byte budget
+    size_t bytes = 0;        // graphMemoryBytes of the cached graphs
+    size_t byte_budget = 0;
+    int graphs = 0;
+};
+
+// A graph returned by GraphCache
+struct CachedGraph {
+    std::shared_ptr<const Graph> graph; // Null if the graph could not be read
+    GraphLoadStats load_stats;          // Of the load that produced graph (files only)
+    bool hit = false;
+    double load_ms = 0.0;               // Time of the load this lookup did, 0 on hits
+    std::string error;                  // Why graph is null
+};
+
+// Graphs shared read-only by threads and repeated runs, within a byte budget with least
+// recently used eviction. Files are keyed by path and format and read again when their
+// modification time or size changes; generated graphs are keyed by their exact parameters.
+// Concurrent lookups of a graph that is being loaded wait for that load. Evicted graphs
+// live on as long as a caller holds them, and a graph larger than the whole budget is
+// returned without being kept. All members are thread-safe.
+class GraphCache {
+public:
+    explicit GraphCache(size_t byte_budget = size_t(1) << 30);
+
+    CachedGraph load(const std::string& filename, GraphFormat format = GraphFormat::Auto, int num_threads = 1);
+    CachedGraph generate(const GraphGeneratorSpec& spec);
+
+    GraphCacheStats stats() const;
+    // Drops every cached graph (graphs being loaded stay)
+    void clear();
+
+private:
+    struct Entry {
+        long long modified_ns; // File modification time and size, 0 for generated graphs
+        long long file_size;
+        long long load_id;     // Tells a finished load whether its entry was replaced meanwhile
+        std::shared_future<CachedGraph> result;
+        bool loaded = false;   // Loads in progress are not counted, nor evicted
+        size_t bytes = 0;
+        std::list<std::string>::iterator lru_position;
+    };
+
+    // Looks key up, or runs build (outside the lock) and caches its graph
+    CachedGraph getOrBuild(const std::string& key, long long modified_ns, long long file_size,
+                           const std::function<bool(Graph&, GraphLoadStats&)>& build);
+    void evictToBudget(); // Called with mutex_ held
+
+    size_t byte_budget_;
+    mutable std::mutex mutex_;
+    std::map<std::string, Entry> entries_;
+    std::list<std::string> lru_; // Most recently used first
+    GraphCacheStats stats_;
+    long long next_load_id_ = 0;
+};
+
+// --- Relabeling ---
+
+// Vertex orderings available for the optional relabeling pass applied after load.
+// Renumbering the vertices so that neighbors get close IDs makes the neighbor
+// color lookups of the algorithms hit nearby memory instead of random cache lines.
+enum class RelabelOrder {
+    None,             // Keep the IDs from the file
+    RCM,              // Reverse Cuthill-McKee (bandwidth reduction)
+    DegreeDescending, // Largest degree first, ties by original ID
+    BFS               // Breadth-first order, one component after the other
+};
+
+// Parses the command line name of a relabeling order. Returns false if unknown.
+bool parseRelabelOrder(const std::string& name, RelabelOrder& order);
+std::string relabelOrderName(RelabelOrder order);
+
+// Renumbers the graph in place. original_ids[new_id] receives the previous ID of every
+// vertex (the identity for RelabelOrder::None).
+void relabelGraph(Graph& graph, RelabelOrder order, std::vector<int>& original_ids);
+
+// Locality of the adjacency lists under the current numbering:
+// bandwidth is the largest |u - v| over all edges, mean_gap the average one.
+struct NeighborLocality {
+    int bandwidth = 0;
+    double mean_gap = 0.0;
+};
+
+NeighborLocality measureNeighborLocality(const Graph& graph);
+
+// --- Coloring ---
+
+enum class Algorithm {
+    FirstFit,
+    WelshPowell,
+    LargestDegreeOrdering,
+    IncidenceDegreeOrdering,
+    DSATUR,
+    RLF,
+    IncidenceDegreeSaturation, // IDO, ties broken by saturation degree
+    DSATURUncoloredDegree      // DSATUR, ties broken by degree among uncolored vertices (Brelaz)
+};
+
+// Short names used in reports and on the command line:
+// FF, WP, LDO, IDO, DSATUR, RLF, IDO-SAT, DSATUR-UD
+std::string algorithmName(Algorithm algorithm);
+bool parseAlgorithm(const std::string& name, Algorithm& algorithm);
+// The six algorithms of the comparison (the variants are only run on request)
+std::vector<Algorithm> allAlgorithms();
+
+// Settings of a coloring run; the defaults are used when none are given
+struct ColoringOptions {
+    // IDO/DSATUR family: give full ties to the vertex that comes first in the initial
+    // degree order, reproducing the colorings of the original implementation. Otherwise
+    // ties go to the first vertex in the (deterministic) order of the O(1) removal set.
+    bool legacy_tie_break = false;
+    // DSATUR family: largest size of the saturation bitsets (one row of 64-bit words per
+    // vertex, about n * k / 8 bytes for k colors). Larger palettes fall back to sets.
+    size_t saturation_memory_limit = size_t(256) << 20;
+    // Break ties randomly instead of by scan order: every algorithm draws a random
+    // permutation of the vertices from seed and lets the lower rank win equal keys
+    // (FF, which has no ties, colors the vertices in that order instead)
+    bool randomize = false;
+    unsigned long long seed = 1;
+};
+
+// Statistics an algorithm reports besides the coloring
+struct ColoringStats {
+    size_t saturation_bytes = 0;        // Peak size of the saturation bitsets (DSATUR family)
+    bool saturation_over_limit = false; // The bitsets hit saturation_memory_limit and were replaced by sets
+};
+
+// A coloring and how it was obtained
+struct ColoringResult {
+    Algorithm algorithm = Algorithm::FirstFit;
+    std::vector<int> colors; // colors[v] in 0..colors_used - 1 for v in 1..n (colors[0] unused)
+    int colors_used = 0;
+    double elapsed_ms = 0.0; // Wall time of the algorithm
+    ColoringStats stats;
+};
+
+// Colors graph with the given algorithm. Thread-safe for concurrent calls.
+ColoringResult colorGraph(const Graph& graph, Algorithm algorithm, const ColoringOptions& options = ColoringOptions());
+
+// Same, reusing the storage of result.colors: with the scratch arena below, repeated runs
+// then make no heap allocation at all
+void colorGraph(const Graph& graph, Algorithm algorithm, const ColoringOptions& options, ColoringResult& result);
+
+// The algorithms themselves: each fills colors (resized to n + 1) and returns the
+// number of colors used. The greedy IDO/DSATUR family also fills stats if given.
+int FirstFit_coloring(const Graph& graph, std::vector<int>& colors, const ColoringOptions& options = ColoringOptions());
+int WelshPowell_coloring(const Graph& graph, std::vector<int>& colors, const ColoringOptions& options = ColoringOptions());
+int LargestDegreeOrdering_coloring(const Graph& graph, std::vector<int>& colors,
+                                   const ColoringOptions& options = ColoringOptions());
+int IDO_coloring(const Graph& graph, std::vector<int>& colors, const ColoringOptions& options = ColoringOptions(),
+                 ColoringStats* stats = nullptr);
+int DSATUR_coloring(const Graph& graph, std::vector<int>& colors, const ColoringOptions& options = ColoringOptions(),
+                    ColoringStats* stats = nullptr);
+int RLF_coloring(const Graph& graph, std::vector<int>& colors, const ColoringOptions& options = ColoringOptions());
+int IDOSaturation_coloring(const Graph& graph, std::vector<int>& colors, const ColoringOptions& options = ColoringOptions(),
+                           ColoringStats* stats = nullptr);
+int DSATURUncoloredDegree_coloring(const Graph& graph, std::vector<int>& colors, const ColoringOptions& options = ColoringOptions(),
+                                   ColoringStats* stats = nullptr);
+
+// The algorithms take their temporary arrays from an arena of the calling thread that is
+// rewound when they return. Once it has grown to fit a graph, further runs on graphs up to
+// that size allocate nothing on the heap (besides the colors vector, unless reused).
+struct ScratchMemoryStats {
+    size_t reserved_bytes = 0;       // Kept by the calling thread's arena between runs
+    long long block_allocations = 0; // Blocks it allocated so far
+};
+
+ScratchMemoryStats scratchMemoryStats();
+// Frees the calling thread's arena, e.g. after an unusually large graph
+void releaseScratchMemory();
+
+// Settings of runMultiStart
+struct MultiStartOptions {
+    int num_seeds = 100;               // Runs with seeds first_seed .. first_seed + num_seeds - 1
+    unsigned long long first_seed = 1;
+    int num_threads = 1;               // 0 uses every core
+};
+
+// Outcome of a multi-start run
+struct MultiStartResult {
+    ColoringResult best;                       // Fewest colors, the lowest seed among equals
+    unsigned long long best_seed = 0;
+    std::vector<int> colors_per_seed;          // Colors used with seed first_seed + i
+    int num_threads = 1;
+    double elapsed_ms = 0.0;                   // Wall time of all runs
+    double colorings_per_second = 0.0;         // Runs per second of wall time
+    double colorings_per_second_per_core = 0.0; // The same, divided by the number of threads
+};
+
+// Colors graph once per seed with randomized tie-breaking, spreading the seeds over
+// threads, and keeps the best coloring. The outcome does not depend on the number of
+// threads. options.randomize and options.seed are set per run.
+MultiStartResult runMultiStart(const Graph& graph, Algorithm algorithm, const ColoringOptions& options,
+                               const MultiStartOptions& multi_start);
+
+// Number of edges whose endpoints share a color (0 for a proper coloring)
+long long countColoringConflicts(const Graph& graph, const std::vector<int>& colors);
+
+// Writes a coloring in DIMACS solution format ("s col K" followed by one
+// "l <vertex> <color>" line per vertex), using the IDs in original_ids and 1-based colors.
+bool writeColoringFile(const std::string& filename, const ColoringResult& result, const std::vector<int>& original_ids);
+
+// --- Improvement ---
+
+// Color class orders of Iterated Greedy (Culberson)
+enum class ClassOrder {
+    Reverse,      // Last class first
+    LargestFirst, // Most vertices first
+    Random,
+    DegreeSum     // Largest sum of vertex degrees first
+};
+
+// Parses "reverse", "largest", "random" or "degree-sum". Returns false if unknown.
+bool parseClassOrder(const std::string& name, ClassOrder& order);
+std::string classOrderName(ClassOrder order);
+
+struct IteratedGreedyOptions {
+    double time_budget_ms = 1000.0;
+    long long max_iterations = 0; // Stop after this many passes instead of the time budget (0 = budget)
+    // Each pass picks one of these orders at random
+    std::vector<ClassOrder> orders = {ClassOrder::Reverse, ClassOrder::LargestFirst, ClassOrder::Random,
+                                      ClassOrder::DegreeSum};
+    unsigned long long seed = 1;
+};
+
+// A pass that used fewer colors than the one before
+struct IteratedGreedyImprovement {
+    long long iteration; // 1-based pass number
+    double elapsed_ms;   // Since the start of iteratedGreedy
+    int colors_used;
+    ClassOrder order;    // Class order of that pass
+};
+
+struct IteratedGreedyResult {
+    ColoringResult coloring; // Final coloring; elapsed_ms includes the initial algorithm
+    int initial_colors = 0;
+    long long iterations = 0;
+    double elapsed_ms = 0.0;
+    double iterations_per_second = 0.0;
+    std::vector<IteratedGreedyImprovement> improvements;
+};
+
+// Iterated Greedy: repeatedly reorders the color classes of the coloring and recolors
+// the vertices class by class with First Fit, in O(n + m) per pass. A class is an
+// independent set, so starting from a proper coloring the number of colors never
+// increases. Runs until the time budget (or max_iterations) is used up. Uncolored
+// vertices (-1) of initial are colored with First Fit after the classes of the first
+// pass, which may then need more colors; colors of colors_used or above make it return
+// initial unchanged.
+IteratedGreedyResult iteratedGreedy(const Graph& graph, const ColoringResult& initial,
+                                    const IteratedGreedyOptions& options = IteratedGreedyOptions());
+
+struct KempeReductionOptions {
+    double time_budget_ms = 1000.0;
+};
+
+struct KempeReductionResult {
+    ColoringResult coloring; // Final coloring; elapsed_ms includes the initial algorithm
+    int initial_colors = 0;
+    int classes_removed = 0;
+    long long direct_moves = 0; // Vertices moved to a color free among their neighbors
+    long long chain_swaps = 0;  // Vertices moved after swapping a Kempe chain
+    double elapsed_ms = 0.0;
+};
+
+// Post-pass that tries to empty color classes, smallest first. Each vertex of the class
+// moves to a color none of its neighbors has or, failing that, to a color c freed by
+// swapping c and another color d on the Kempe chains through its c-colored neighbors
+// (when those chains reach none of its d-colored neighbors). When a class empties, the
+// last color is renumbered into it and the search starts over, until no class can be
+// emptied or the time budget is used up; the budget is also checked before every chain
+// search. The coloring stays legal throughout. Uncolored vertices (-1) stay uncolored;
+// colors of colors_used or above make the pass return initial unchanged.
+KempeReductionResult reduceColorsByKempeChains(const Graph& graph, const ColoringResult& initial,
+                                               const KempeReductionOptions& options = KempeReductionOptions());
+
+// --- Dynamic coloring ---
+
+struct DynamicColoringStats {
+    long long updates = 0;            // Edge and vertex insertions and removals applied
+    long long recolored_vertices = 0; // Vertices whose color was set or changed by the updates
+    int max_recolored = 0;            // Most vertices recolored by a single update
+    long long new_colors = 0;         // Repairs that had to open a color class
+    long long neighbor_moves = 0;     // Repairs that avoided a new class by moving one neighbor
+};
+
+// A graph that changes by edge and vertex insertions and removals, with a coloring kept
+// legal by local repairs instead of recoloring from scratch. An edge between two
+// vertices of the same color recolors one endpoint with the smallest color free among
+// its neighbors, preferring the endpoint that needs no new color, then the one with the
+// smaller degree; new vertices are colored the same way. Before a repair opens a new
+// class, it tries to take a color held by a single neighbor, which moves to another
+// existing color (up to 16 neighbors are tried). Removals never recolor, so over long
+// update sequences the color count drifts above that of a coloring from scratch.
+// Every adjacency entry knows its position in the other endpoint's list, so removing an
+// edge found in either list is O(1). Edge updates cost O(smaller degree) for the lookup,
+// vertex updates O(degree), repairs O(degree) plus the palette size in 64-bit words.
+class DynamicColoring {
+public:
+    // Starts from graph and a legal coloring of it, e.g. ColoringResult::colors. Vertices
+    // it leaves uncolored (-1, or past its end) get their first free color, in ID order.
+    DynamicColoring(const Graph& graph, const std::vector<int>& colors);
+
+    // Each update returns the number of vertices it recolored (0 to 2)
+    int addEdge(int u, int v);    // Ignores self-loops, existing edges and unknown vertices
+    int removeEdge(int u, int v); // Ignores missing edges
+    int removeVertex(int v);      // Removes v with its edges; IDs are not reused
+    // Adds a vertex adjacent to the given (existing) vertices, colors it and returns its ID
+    int addVertex(const std::vector<int>& neighbors);
+
+    bool hasVertex(int v) const { return v >= 1 && v < static_cast<int>(active_.size()) && active_[v]; }
+    bool hasEdge(int u, int v) const;
+    int maxVertexId() const { return static_cast<int>(adjacency_.size()) - 1; }
+    int numVertices() const { return num_vertices_; } // Not removed
+    long long numEdges() const { return num_edges_; }
+    const std::vector<int>& neighbors(int v) const { return adjacency_[v]; } // Unordered
+    int color(int v) const { return colors_[v]; } // -1 for removed vertices
+    int numColors() const { return nonempty_classes_; }
+    const DynamicColoringStats& stats() const { return stats_; }
+
+    // Snapshots: removed vertices stay as isolated IDs without color; the coloring is
+    // renumbered to 0..numColors() - 1
+    Graph graph() const;
+    ColoringResult coloring() const;
+
+private:
+    int firstFreeColor(int vertex, int skip = -1, int also_forbidden = -1);
+    bool recolorThroughNeighbor(int vertex);
+    void pushEdgeEntries(int u, int v);
+    void removeEntry(int vertex, int index);
+    void setColor(int vertex, int color);
+    void recordUpdate(int recolored);
+
+    std::vector<std::vector<int>> adjacency_;
+    std::vector<std::vector<int>> twin_; // twin_[v][i]: position of v in adjacency_[adjacency_[v][i]]
+    std::vector<bool> active_;
+    std::vector<int> colors_;
+    std::vector<int> class_size_;
+    int nonempty_classes_ = 0;
+    int num_vertices_ = 0;
+    long long num_edges_ = 0;
+    std::vector<uint64_t> forbidden_words_; // Neighbor colors during a repair, 64 per word; zero between repairs
+    std::vector<int> neighbor_color_count_; // Neighbors per color in recolorThroughNeighbor; zero between repairs
+    DynamicColoringStats stats_;
+};
+
+// --- Evolutionary search ---
+
+struct HEAOptions {
+    double time_budget_ms = 10000.0;
+    int population_size = 10;
+    long long tabu_iterations = 10000; // TabuCol moves applied to every new individual
+    int target_colors = 0;             // Stop once a legal coloring with this many colors is found
+    int num_threads = 1;               // 0 uses every core
+    unsigned long long seed = 1;
+    // Largest size of the TabuCol tables of all threads together, (n + 1) * k ints and long
+    // longs per thread for k colors: fewer threads search when more would exceed it
+    size_t tabu_memory_limit = size_t(1) << 30;
+    // Settings of the greedy colorings of the initial population; randomize and seed are
+    // set per member
+    ColoringOptions coloring;
+};
+
+// A legal coloring with fewer colors than the best before
+struct HEAProgress {
+    double elapsed_ms;
+    long long generation; // 0 for the initial population
+    int colors_used;
+};
+
+struct HEAResult {
+    ColoringResult coloring; // Best legal coloring (algorithm is the one of the best initial member)
+    int initial_colors = 0;  // Best coloring of the initial population
+    long long generations = 0;
+    int num_threads = 1;          // Threads of the search, after tabu_memory_limit
+    size_t tabu_table_bytes = 0;  // Allocated by the TabuCol tables of those threads
+    double elapsed_ms = 0.0;
+    std::vector<HEAProgress> progress;
+};
+
+// Hybrid evolutionary algorithm (Galinier and Hao). The population is seeded with
+// randomized DSATUR, RLF and LDO colorings; then, for one color less than the best legal
+// coloring so far, every generation crosses random pairs of members with GPX (greedy
+// partition crossover), improves each child with TabuCol and lets it replace the worse
+// parent. Children are built and improved in parallel, one per thread. Whenever a legal
+// coloring is found the target drops by one color, until the time budget is used up.
+HEAResult runHybridEvolutionary(const Graph& graph, const HEAOptions& options = HEAOptions());
+
+// --- Fixed number of colors ---
+
+struct PartialColOptions {
+    Algorithm initial_algorithm = Algorithm::DSATUR; // Greedy coloring the search starts from
+    double time_budget_ms = 10000.0;
+    long long max_iterations = 0; // Also stop after this many moves (0 = budget only)
+    unsigned long long seed = 1;
+};
+
+struct PartialColResult {
+    bool success = false;     // A legal coloring with at most the requested colors was found
+    ColoringResult coloring;  // On failure, the best partial coloring (uncolored vertices are -1)
+    int initial_uncolored = 0; // Vertices of the truncated greedy coloring left without a color
+    int uncolored = 0;         // Vertices still without a color (0 on success)
+    long long iterations = 0;
+    double elapsed_ms = 0.0;   // Including the initial greedy coloring
+    double iterations_per_second = 0.0;
+};
+
+// PartialCol (Bloechliger and Zufferey): looks for a legal coloring with num_colors
+// colors. Starting from the initial greedy coloring without its vertices of color
+// num_colors and above, it keeps a legal partial coloring and moves uncolored vertices
+// into color classes, uncoloring their neighbors there, guided by a tabu list and a
+// vertex-by-color table of colored neighbors that makes every move O(1) to evaluate.
+// Returns as soon as no vertex is left uncolored or the budget is used up.
+PartialColResult runPartialCol(const Graph& graph, int num_colors, const PartialColOptions& options = PartialColOptions());
+
+// --- Phase tracing ---
+
+// Phases of the coloring engines reported by the phase-level tracing.
+enum TracePhase {
+    PhaseOrdering,    // Sorting vertices by degree
+    PhaseHeuristic,   // Computing heuristic values (RLF neighbors in U)
+    PhaseSelection,   // Picking the next vertex from the candidates
+    PhaseColorSearch, // Finding the smallest legal color (isColorValid, available color scans)
+    PhaseRemoval,     // Removing colored vertices from the uncolored set
+    PhaseUpdate,      // Maintaining auxiliary state after coloring a vertex (greedy keys, RLF forbidden set)
+    NumTracePhases
+};
+
+const char* tracePhaseName(int phase);
+
+#ifdef GC_TRACE
+struct TraceRegistry;
+
+// Phase-level tracing, compiled in with -DGC_TRACE (library and callers alike). Each
+// engine wraps its phases in TRACE_PHASE scopes and reports operation counts with
+// TRACE_OPS; the tracer keeps per-phase totals for the current run and, when enabled,
+// a bounded list of Chrome trace events. One tracer per thread, so concurrent runs do
+// not interfere; the tracers register with a process-wide list so that the trace file
+// holds the events of every thread (multi-start seeds, HEA, server workers), each under
+// its own thread ID, including threads that have exited since.
+class PhaseTracer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static PhaseTracer& current();
+
+    ~PhaseTracer();
+
+    // Clears the per-phase totals of this thread before a new run
+    void resetTotals();
+    void record(int phase, Clock::time_point start, Clock::time_point end);
+    void addOps(int phase, long long ops) { ops_[phase] += ops; }
+    // Starts keeping Chrome trace events on every thread, dropping any beyond max_events
+    // (over all threads together)
+    static void enableEvents(size_t max_events);
+    // Adds an enclosing event for an algorithm run that just finished after elapsed_ms
+    void recordRun(const std::string& name, double elapsed_ms);
+    // Per-phase totals of the current run on this thread, one indented line per phase that was entered
+    std::string formatTotals() const;
+    // Writes the events of all threads in the Chrome trace-event JSON format (chrome://tracing,
+    // Perfetto). Call it while no other thread is tracing, e.g. after joining the workers.
+    static bool writeChromeTrace(const std::string& filename);
+
+private:
+    friend struct TraceRegistry;
+
+    struct Event {
+        int phase; // TracePhase, or -(index + 1) into the registry's run names for run events
+        int tid;
+        double ts_us;
+        double dur_us;
+    };
+
+    PhaseTracer();
+    void addEvent(int phase, Clock::time_point start, Clock::time_point end);
+
+    int tid_;
+    long long total_ns_[NumTracePhases];
+    long long scopes_[NumTracePhases];
+    long long ops_[NumTracePhases];
+    std::vector<Event> events_;
+};
+#endif
+
+#endif // GRAPH_COLORING_H
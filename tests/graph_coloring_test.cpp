@@ -0,0 +1,290 @@
+#include "graph_coloring.h"
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <algorithm>  // For std::count
+#include <filesystem> // For the temporary folder of the converted instances
+#include <unistd.h>   // For getpid
+
+// Checks of the library against the bundled DIMACS instances. Each check prints what
+// failed; main returns non-zero if any did.
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+// The neighbor lists of a graph, row v at index v
+static std::vector<std::vector<int>> graphRows(const Graph& graph) {
+    return graph.visit([&](const auto& view) {
+        std::vector<std::vector<int>> rows(view.numVertices() + 1);
+        for (int v = 1; v <= view.numVertices(); ++v) {
+            for (int u : view.neighbors(v)) {
+                rows[v].push_back(u);
+            }
+            if (static_cast<int>(rows[v].size()) != view.degree(v)) {
+                rows[v].push_back(-1); // Degree and row disagree
+            }
+        }
+        return rows;
+    });
+}
+
+static bool loadGraph(const std::string& filename, Graph& graph, GraphFormat format = GraphFormat::Auto,
+                      int num_threads = 1) {
+    GraphLoadStats stats;
+    bool loaded = readGraphFile(filename, graph, stats, format, num_threads);
+    check(loaded, "loading '" + filename + "'");
+    return loaded;
+}
+
+// Writers of the other input formats, from the rows of a loaded graph
+
+static void writeDimacsBinary(const std::string& filename, const std::vector<std::vector<int>>& rows, long long num_edges) {
+    int n = static_cast<int>(rows.size()) - 1;
+    std::string preamble = "c converted by graph_coloring_test\np edge " + std::to_string(n) + " " +
+                           std::to_string(num_edges) + "\n";
+    std::ofstream file(filename, std::ios::binary);
+    file << preamble.size() << "\n" << preamble;
+    for (int i = 0; i < n; ++i) {
+        std::vector<unsigned char> row((i + 8) / 8, 0);
+        for (int u : rows[i + 1]) {
+            int j = u - 1;
+            if (j < i) {
+                row[j / 8] |= 0x80 >> (j % 8);
+            }
+        }
+        file.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size()));
+    }
+}
+
+static void writeMetis(const std::string& filename, const std::vector<std::vector<int>>& rows, long long num_edges) {
+    std::ofstream file(filename);
+    file << "% converted by graph_coloring_test\n" << rows.size() - 1 << " " << num_edges << "\n";
+    for (size_t v = 1; v < rows.size(); ++v) {
+        for (size_t i = 0; i < rows[v].size(); ++i) {
+            file << (i == 0 ? "" : " ") << rows[v][i];
+        }
+        file << "\n";
+    }
+}
+
+// 0-based, as most edge list producers write them
+static void writeEdgeList(const std::string& filename, const std::vector<std::vector<int>>& rows) {
+    std::ofstream file(filename);
+    file << "# converted by graph_coloring_test\n";
+    for (size_t v = 1; v < rows.size(); ++v) {
+        for (int u : rows[v]) {
+            if (static_cast<size_t>(u) > v) {
+                file << v - 1 << " " << u - 1 << "\n";
+            }
+        }
+    }
+}
+
+// The same instance in every input format gives the same graph
+static void checkFormatsAgree(const std::string& instance, const std::string& folder) {
+    Graph dimacs;
+    if (!loadGraph(instance, dimacs)) {
+        return;
+    }
+    std::vector<std::vector<int>> rows = graphRows(dimacs);
+    long long num_edges = 0;
+    for (const auto& row : rows) {
+        num_edges += static_cast<long long>(row.size());
+    }
+    num_edges /= 2;
+
+    writeDimacsBinary(folder + "/instance.col.b", rows, num_edges);
+    writeMetis(folder + "/instance.graph", rows, num_edges);
+    writeEdgeList(folder + "/instance.el", rows);
+    for (const char* name : {"instance.col.b", "instance.graph", "instance.el"}) {
+        Graph converted;
+        if (loadGraph(folder + "/" + name, converted)) {
+            check(graphRows(converted) == rows, std::string(name) + " gives the rows of " + instance);
+        }
+    }
+
+    // Without an extension the format is sniffed from the content. Every METIS line of a
+    // cycle has two fields, like the header, which once made it look like an edge list.
+    writeMetis(folder + "/cycle", {{}, {2, 4}, {1, 3}, {2, 4}, {1, 3}}, 4);
+    Graph cycle;
+    if (loadGraph(folder + "/cycle", cycle)) {
+        check(cycle.numVertices() == 4 && cycle.numEdges() == 4 && graphRows(cycle)[1] == std::vector<int>({2, 4}),
+              "a METIS cycle without extension is read as METIS");
+    }
+
+    // Sparse edge list IDs are renumbered instead of allocating a row per unused ID
+    {
+        std::ofstream file(folder + "/sparse.el");
+        file << "5 1000000000\n2000000000 5\n";
+    }
+    Graph sparse;
+    if (loadGraph(folder + "/sparse.el", sparse)) {
+        check(sparse.numVertices() == 3 && graphRows(sparse)[1] == std::vector<int>({2, 3}),
+              "sparse edge list IDs are renumbered 1..3");
+    }
+}
+
+// The parallel loader gives the graph and the statistics of the sequential one, also when
+// the chunk boundaries fall inside lines and the file repeats, loops and misnumbers edges
+static void checkParallelLoad(const std::string& instance, const std::string& folder) {
+    std::string messy = folder + "/messy.col";
+    {
+        std::ofstream file(messy);
+        file << "c duplicates, loops and IDs out of range\np edge 6 9\n"
+             << "e 1 2\ne 2 1\ne 3 3\ne 2 3\ne 4 7\ne 1 2\ne 5 6\ne 0 4\ne 6 1\n";
+    }
+    for (const std::string& filename : {instance, messy}) {
+        Graph sequential;
+        Graph parallel;
+        GraphLoadStats sequential_stats;
+        GraphLoadStats parallel_stats;
+        bool loaded = readGraphFile(filename, sequential, sequential_stats, GraphFormat::Auto, 1) &&
+                      readGraphFile(filename, parallel, parallel_stats, GraphFormat::Auto, 7);
+        check(loaded, "loading '" + filename + "' on 1 and 7 threads");
+        if (!loaded) {
+            continue;
+        }
+        check(graphRows(parallel) == graphRows(sequential) && parallel.numEdges() == sequential.numEdges(),
+              "the parallel loader gives the rows of the sequential one for '" + filename + "'");
+        check(parallel_stats.edge_lines == sequential_stats.edge_lines &&
+                  parallel_stats.self_loops == sequential_stats.self_loops &&
+                  parallel_stats.duplicate_edges == sequential_stats.duplicate_edges &&
+                  parallel_stats.invalid_edges == sequential_stats.invalid_edges &&
+                  parallel_stats.simple_edges == sequential_stats.simple_edges,
+              "the parallel loader counts the edges like the sequential one for '" + filename + "'");
+    }
+}
+
+// With the legacy tie-break IDO and DSATUR reproduce the color counts of the original
+// implementation (results.log of the first version: 70 and 65 colors on dsjc500.5)
+static void checkLegacyTieBreak(const std::string& instance) {
+    Graph graph;
+    if (!loadGraph(instance, graph)) {
+        return;
+    }
+    ColoringOptions options;
+    options.legacy_tie_break = true;
+    check(colorGraph(graph, Algorithm::IncidenceDegreeOrdering, options).colors_used == 70,
+          "IDO with the legacy tie-break uses 70 colors on " + instance);
+    check(colorGraph(graph, Algorithm::DSATUR, options).colors_used == 65,
+          "DSATUR with the legacy tie-break uses 65 colors on " + instance);
+}
+
+// Compressed rows decode to the CSR rows, with the same degrees and colorings
+static void checkCompressedAdjacency(const std::string& instance) {
+    Graph graph;
+    if (!loadGraph(instance, graph)) {
+        return;
+    }
+    GraphGeneratorSpec spec;
+    parseGeneratorSpec("geo:n=20000,r=0.02,seed=3", spec); // Wide gaps besides the small ones
+    Graph generated;
+    generateGraph(spec, generated);
+    for (Graph* plain : {&graph, &generated}) {
+        std::vector<std::vector<int>> rows = graphRows(*plain);
+        int colors_used = colorGraph(*plain, Algorithm::LargestDegreeOrdering).colors_used;
+        Graph compressed = *plain;
+        check(compressed.compressAdjacency() && compressed.compressed(), "compressing the adjacency");
+        check(graphRows(compressed) == rows, "compressed rows decode to the CSR rows");
+        bool same_degrees = true;
+        for (int v = 1; v <= plain->numVertices(); ++v) {
+            same_degrees = same_degrees && compressed.degree(v) == plain->degree(v);
+        }
+        check(same_degrees, "compressed degrees match the CSR degrees");
+        check(colorGraph(compressed, Algorithm::LargestDegreeOrdering).colors_used == colors_used,
+              "LDO colors a compressed graph like the CSR one");
+    }
+}
+
+// The Kempe pass keeps to its budget and leaves uncolored vertices alone
+static void checkKempeReduction(const std::string& instance) {
+    Graph graph;
+    if (!loadGraph(instance, graph)) {
+        return;
+    }
+    ColoringResult initial = colorGraph(graph, Algorithm::FirstFit);
+    initial.colors[1] = -1;
+    KempeReductionOptions options;
+    options.time_budget_ms = 20.0;
+    KempeReductionResult reduced = reduceColorsByKempeChains(graph, initial, options);
+    check(reduced.coloring.colors[1] == -1 && countColoringConflicts(graph, reduced.coloring.colors) == 0,
+          "the Kempe pass keeps a partial coloring legal");
+
+    // No budget, no work: the budget is checked before the first class is tried
+    options.time_budget_ms = 0.0;
+    KempeReductionResult unchanged = reduceColorsByKempeChains(graph, initial, options);
+    check(unchanged.coloring.colors == initial.colors && unchanged.direct_moves == 0 && unchanged.chain_swaps == 0,
+          "the Kempe pass moves nothing with a budget of 0 ms");
+}
+
+// Iterated Greedy completes a partial coloring and leaves one with colors out of range alone
+static void checkIteratedGreedyPartial(const std::string& instance) {
+    Graph graph;
+    if (!loadGraph(instance, graph)) {
+        return;
+    }
+    PartialColOptions partial_options;
+    partial_options.max_iterations = 1000;
+    PartialColResult partial = runPartialCol(graph, 20, partial_options); // Fails, leaving vertices uncolored
+    check(!partial.success && partial.uncolored > 0, "PartialCol leaves vertices uncolored with 20 colors");
+    IteratedGreedyOptions options;
+    options.max_iterations = 10;
+    IteratedGreedyResult improved = iteratedGreedy(graph, partial.coloring, options);
+    check(std::count(improved.coloring.colors.begin() + 1, improved.coloring.colors.end(), -1) == 0 &&
+              countColoringConflicts(graph, improved.coloring.colors) == 0,
+          "Iterated Greedy completes a partial coloring legally");
+
+    ColoringResult out_of_range = colorGraph(graph, Algorithm::FirstFit);
+    out_of_range.colors_used--;
+    check(iteratedGreedy(graph, out_of_range, options).coloring.colors == out_of_range.colors,
+          "Iterated Greedy returns a coloring with colors out of range unchanged");
+}
+
+// A dynamic coloring started from a partial coloring colors the rest, and stays legal
+static void checkDynamicColoring(const std::string& instance) {
+    Graph graph;
+    if (!loadGraph(instance, graph)) {
+        return;
+    }
+    std::vector<int> colors = colorGraph(graph, Algorithm::DSATUR).colors;
+    colors.resize(graph.numVertices() / 2); // The second half is uncolored
+    DynamicColoring dynamic(graph, colors);
+    for (int v = 1; v + 7 <= graph.numVertices(); v += 7) {
+        dynamic.addEdge(v, v + 7);
+    }
+    Graph final_graph = dynamic.graph();
+    ColoringResult coloring = dynamic.coloring();
+    check(std::count(coloring.colors.begin() + 1, coloring.colors.end(), -1) == 0 &&
+              countColoringConflicts(final_graph, coloring.colors) == 0,
+          "a dynamic coloring from a partial coloring is complete and legal");
+}
+
+int main(int argc, char** argv) {
+    std::string instances = argc > 1 ? argv[1] : "DIMACS_Graphs_Instances";
+    std::string folder = (std::filesystem::temp_directory_path() / ("graph_coloring_test_" + std::to_string(getpid()))).string();
+    std::filesystem::create_directories(folder);
+
+    checkParallelLoad(instances + "/dsjc500.5.col", folder);
+    checkFormatsAgree(instances + "/dsjc250.5.col", folder);
+    checkLegacyTieBreak(instances + "/dsjc500.5.col");
+    checkCompressedAdjacency(instances + "/le450_25c.col");
+    checkKempeReduction(instances + "/dsjc500.5.col");
+    checkIteratedGreedyPartial(instances + "/dsjc250.5.col");
+    checkDynamicColoring(instances + "/dsjc250.5.col");
+
+    std::filesystem::remove_all(folder);
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+}